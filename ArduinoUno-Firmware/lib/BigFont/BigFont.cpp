@@ -0,0 +1,56 @@
+#include <Arduino.h>
+#include "BigFont.h"
+
+// Characters in the table below, in order
+static const char FONT_CHARS[] PROGMEM = "0123456789-%\xF7#"
+                                         "ABCDEGHIMOPRSTUV";
+
+static const uint8_t FONT_COLUMNS[][BIGFONT_W] PROGMEM = {
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0
+    {0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
+    {0x72, 0x49, 0x49, 0x49, 0x46}, // 2
+    {0x21, 0x41, 0x49, 0x4D, 0x33}, // 3
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, // 5
+    {0x3C, 0x4A, 0x49, 0x49, 0x31}, // 6
+    {0x41, 0x21, 0x11, 0x09, 0x07}, // 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, // 8
+    {0x46, 0x49, 0x49, 0x29, 0x1E}, // 9
+    {0x08, 0x08, 0x08, 0x08, 0x08}, // -
+    {0x23, 0x13, 0x08, 0x64, 0x62}, // %
+    {0x00, 0x06, 0x09, 0x09, 0x06}, // degree
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, // #
+    {0x7C, 0x12, 0x11, 0x12, 0x7C}, // A
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, // B
+    {0x3E, 0x41, 0x41, 0x41, 0x22}, // C
+    {0x7F, 0x41, 0x41, 0x41, 0x3E}, // D
+    {0x7F, 0x49, 0x49, 0x49, 0x41}, // E
+    {0x3E, 0x41, 0x41, 0x51, 0x73}, // G
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // H
+    {0x00, 0x41, 0x7F, 0x41, 0x00}, // I
+    {0x7F, 0x02, 0x1C, 0x02, 0x7F}, // M
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, // P
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, // R
+    {0x26, 0x49, 0x49, 0x49, 0x32}, // S
+    {0x03, 0x01, 0x7F, 0x01, 0x03}, // T
+    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // V
+};
+
+uint8_t bigFontColumn(char c, uint8_t col)
+{
+  if (col >= BIGFONT_W)
+  {
+    return 0; // spacing
+  }
+
+  for (uint8_t i = 0; i < sizeof(FONT_COLUMNS) / BIGFONT_W; i++)
+  {
+    if ((char)pgm_read_byte(&FONT_CHARS[i]) == c)
+    {
+      return pgm_read_byte(&FONT_COLUMNS[i][col]);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,29 @@
+/**
+ * Glyphs for the stats strip, stored in PROGMEM.
+ *
+ * Only the characters the stats widgets and overview tiles use are kept:
+ * digits, '-', '%', the degree sign (char 247, as in the GFX font), '#' for
+ * plant numbers and the capitals of the labels and moisture words. They are
+ * the same 5x7 shapes as the built-in GFX font, one byte per column with
+ * bit 0 at the top, so the strip looks the same as with tft.print() at the
+ * same text size.
+ *
+ * The glyphs are meant to be blitted a whole cell at a time (background
+ * included) with one address window, instead of the one fillRect per
+ * scaled pixel that Adafruit_GFX text needs.
+ */
+
+#ifndef BIG_FONT_H
+#define BIG_FONT_H
+
+#include <stdint.h>
+
+#define BIGFONT_W 5      // glyph columns
+#define BIGFONT_H 8      // rows, the last one is always blank
+#define BIGFONT_CELL_W 6 // glyph plus one column of spacing
+
+// Column `col` of the cell for c, bit n = row n. Characters that are not in
+// the font, and the spacing column, are blank.
+uint8_t bigFontColumn(char c, uint8_t col);
+
+#endif
@@ -0,0 +1,103 @@
+#include "BinaryFrame.h"
+
+uint8_t crc8(const uint8_t *data, uint8_t length)
+{
+  uint8_t crc = 0x00;
+
+  for (uint8_t i = 0; i < length; i++)
+  {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+bool readSample(const uint8_t *payload, uint8_t length, SampleFrame &sample)
+{
+  if (length != SAMPLE_PAYLOAD_SIZE && length != SAMPLE_PAYLOAD_SIZE + 1)
+  {
+    return false;
+  }
+
+  sample.fields = payload[0];
+  sample.tempTenths = (int16_t)(payload[1] | (payload[2] << 8));
+  sample.humidity = payload[3];
+  sample.moisture = (uint16_t)(payload[4] | (payload[5] << 8));
+  sample.channel = length > SAMPLE_PAYLOAD_SIZE ? payload[6] : 0;
+  return true;
+}
+
+FrameDecoder::FrameDecoder()
+{
+  reset();
+}
+
+void FrameDecoder::reset()
+{
+  _length = 0;
+  _remaining = 0;
+  _code = 0;
+  _overflow = false;
+}
+
+FrameStatus FrameDecoder::feed(uint8_t b)
+{
+  if (b == 0x00)
+  {
+    if (_code == 0)
+    {
+      // Back-to-back delimiters, nothing in between
+      reset();
+      return FRAME_PENDING;
+    }
+
+    // Delimiter: the last block must be complete and the CRC must match
+    bool valid = !_overflow && _remaining == 0 && _length >= 3 &&
+                 crc8(_buffer, _length - 1) == _buffer[_length - 1];
+    uint8_t length = _length;
+
+    reset();
+    _length = length; // keep it for the accessors
+    return valid ? FRAME_OK : FRAME_BAD;
+  }
+
+  if (_code == 0 && _length != 0)
+  {
+    // First byte after a completed frame
+    _length = 0;
+  }
+
+  if (_overflow)
+  {
+    return FRAME_PENDING; // wait for the next delimiter
+  }
+
+  if (_remaining == 0)
+  {
+    // Code byte: every block except a full 0xFF one ends in an implied zero
+    if (_code != 0 && _code != 0xFF)
+    {
+      if (_length >= FRAME_MAX_DECODED)
+      {
+        _overflow = true;
+        return FRAME_PENDING;
+      }
+      _buffer[_length++] = 0x00;
+    }
+    _code = b;
+    _remaining = b - 1;
+    return FRAME_PENDING;
+  }
+
+  if (_length >= FRAME_MAX_DECODED)
+  {
+    _overflow = true;
+    return FRAME_PENDING;
+  }
+  _buffer[_length++] = b;
+  _remaining--;
+  return FRAME_PENDING;
+}
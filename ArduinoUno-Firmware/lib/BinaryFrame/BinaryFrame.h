@@ -0,0 +1,79 @@
+/**
+ * Binary framing for the Server -> Uno link (see shared/protocol.md).
+ *
+ * A frame is   [type][seq][payload...][crc8]   COBS-encoded and terminated
+ * by a 0x00 byte, so the receiver can always resync on the next delimiter.
+ * The CRC is CRC-8 (poly 0x07, init 0x00) over type, seq and payload.
+ *
+ * FrameDecoder undoes the COBS encoding byte by byte into a fixed buffer
+ * and checks length and CRC when the delimiter arrives; no heap is used.
+ */
+
+#ifndef BINARY_FRAME_H
+#define BINARY_FRAME_H
+
+#include <stdint.h>
+
+#define FRAME_MAX_PAYLOAD 24
+#define FRAME_MAX_DECODED (FRAME_MAX_PAYLOAD + 3) // type + seq + payload + crc
+
+// Frame types
+#define FRAME_SAMPLE 0x01 // sensor sample, see SampleFrame
+#define FRAME_MOOD 0x02   // 1 byte: 0 = healthy, 1 = unhealthy
+#define FRAME_VOICE 0x03  // voice text, not NUL-terminated
+#define FRAME_TEXT 0x04   // leave binary mode, back to text commands
+#define FRAME_VIEW 0x05   // 1 byte: channel to show, or VIEW_OVERVIEW
+
+#define VIEW_OVERVIEW 0xFF
+
+// FRAME_SAMPLE payload, little-endian, SAMPLE_PAYLOAD_SIZE bytes, plus a
+// channel byte for any channel but 0
+#define SAMPLE_HAS_TEMP 0x01
+#define SAMPLE_HAS_HUMID 0x02
+#define SAMPLE_HAS_MOIST 0x04
+#define SAMPLE_PAYLOAD_SIZE 6
+
+struct SampleFrame
+{
+  uint8_t fields;    // SAMPLE_HAS_* bits for the values below that are set
+  int16_t tempTenths; // temperature in 0.1 C
+  uint8_t humidity;  // %RH
+  uint16_t moisture; // raw ADC counts
+  uint8_t channel;   // plant the values belong to
+};
+
+// Result of FrameDecoder::feed()
+enum FrameStatus : uint8_t
+{
+  FRAME_PENDING, // need more bytes
+  FRAME_OK,      // type()/seq()/payload() describe a valid frame
+  FRAME_BAD      // delimiter reached but the frame was malformed or failed its CRC
+};
+
+uint8_t crc8(const uint8_t *data, uint8_t length);
+
+// Unpack a FRAME_SAMPLE payload; false if the length is wrong
+bool readSample(const uint8_t *payload, uint8_t length, SampleFrame &sample);
+
+class FrameDecoder
+{
+public:
+  FrameDecoder();
+
+  FrameStatus feed(uint8_t b);
+  void reset();
+
+  uint8_t type() const { return _buffer[0]; }
+  uint8_t seq() const { return _buffer[1]; }
+  const uint8_t *payload() const { return _buffer + 2; }
+  uint8_t payloadLength() const { return _length - 3; }
+
+private:
+  uint8_t _length;    // decoded bytes so far
+  uint8_t _remaining; // data bytes left in the current COBS block
+  uint8_t _code;      // code byte of the current block (0 = none yet)
+  bool _overflow;
+  uint8_t _buffer[FRAME_MAX_DECODED + 1]; // +1 keeps text payloads NUL-terminable
+};
+
+#endif
@@ -0,0 +1,337 @@
+#include "CommandParser.h"
+
+// Tokenizer states
+enum
+{
+  ST_START,     // skipping leading whitespace
+  ST_S,         // "S", maybe followed by channel digits
+  ST_S_SPACE,   // "S "
+  ST_S_FIELD,   // "S T" or "C"
+  ST_NUM_SPACE, // "S T " - whitespace before the number
+  ST_NUM,       // inside the number
+  ST_NUM_DONE,  // after the number, rest is ignored
+  ST_V,         // "V"
+  ST_V_TEXT,    // "V " - collecting voice text
+  ST_SINGLE,    // one-letter command, only whitespace may follow
+  ST_TAG,       // "#" - sequence number digits
+  ST_JUNK       // not a command, wait for the end of the line
+};
+
+#define NUM_LIMIT 32767
+
+static bool isSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\v' || c == '\f';
+}
+
+CommandParser::CommandParser()
+{
+  reset();
+}
+
+void CommandParser::reset()
+{
+  restart();
+  startLine();
+  _field = 0;
+  _value = 0;
+  _line[0] = '\0';
+}
+
+// Get ready for the next line without touching the last result
+void CommandParser::restart()
+{
+  _state = ST_START;
+  _count = 0;
+  _length = 0;
+  _trimmed = 0;
+  _textStart = 0;
+  _negative = false;
+  _hasArg = false;
+  _accum = 0;
+}
+
+// A new line starts untagged
+void CommandParser::startLine()
+{
+  _type = CMD_NONE;
+  _textStart = 0;
+  _tagged = false;
+  _seq = 0;
+  _channel = 0;
+}
+
+bool CommandParser::feed(char c)
+{
+  if (c == '\r')
+  {
+    return false;
+  }
+
+  if (c == '\n')
+  {
+    if (_state == ST_START && _length == 0)
+    {
+      // Blank line: the last line's tag does not carry over
+      startLine();
+    }
+    finishLine();
+    return _type != CMD_NONE;
+  }
+
+  if (_state == ST_START && _length == 0)
+  {
+    // Start of a new line: forget the last result
+    startLine();
+  }
+
+  // Prevent buffer overflow: drop the line and start over
+  if (++_count > PARSER_MAX_LINE)
+  {
+    reset();
+    return false;
+  }
+
+  bool space = isSpace(c);
+
+  if (_state == ST_START && space)
+  {
+    return false;
+  }
+
+  _line[_length++] = c;
+  if (!space)
+  {
+    _trimmed = _length;
+  }
+
+  switch (_state)
+  {
+  case ST_START:
+    if (c == 'S')
+    {
+      _state = ST_S;
+    }
+    else if (c == 'V')
+    {
+      _state = ST_V;
+    }
+    else if (c == 'C')
+    {
+      _field = c; // takes a number like "S T"
+      _state = ST_S_FIELD;
+    }
+    else if (c == 'H' || c == 'U' || c == 'P' || c == 'B' || c == 'O' || c == 'R')
+    {
+      _field = c;
+      _state = ST_SINGLE;
+    }
+    else if (c == '#' && !_tagged)
+    {
+      _tagged = true;
+      _accum = -1; // no digits yet
+      _state = ST_TAG;
+    }
+    else
+    {
+      _state = ST_JUNK;
+    }
+    break;
+
+  case ST_S:
+    if (c >= '0' && c <= '9')
+    {
+      uint16_t channel = _channel * 10 + (c - '0');
+      _channel = (uint8_t)channel;
+      if (channel > 255)
+      {
+        _state = ST_JUNK;
+      }
+    }
+    else
+    {
+      _state = (c == ' ') ? ST_S_SPACE : ST_JUNK;
+    }
+    break;
+
+  case ST_S_SPACE:
+    if (c == 'T' || c == 'H' || c == 'M')
+    {
+      _field = c;
+      _state = ST_S_FIELD;
+    }
+    else
+    {
+      _state = ST_JUNK;
+    }
+    break;
+
+  case ST_S_FIELD:
+    _state = (c == ' ') ? ST_NUM_SPACE : ST_JUNK;
+    break;
+
+  case ST_NUM_SPACE:
+    if (space)
+    {
+      break;
+    }
+    _hasArg = true;
+    if (c == '-' || c == '+')
+    {
+      _negative = (c == '-');
+      _state = ST_NUM;
+    }
+    else if (c >= '0' && c <= '9')
+    {
+      _accum = c - '0';
+      _state = ST_NUM;
+    }
+    else
+    {
+      _state = ST_NUM_DONE;
+    }
+    break;
+
+  case ST_NUM:
+    if (c >= '0' && c <= '9')
+    {
+      _accum = _accum * 10 + (c - '0');
+      if (_accum > NUM_LIMIT)
+      {
+        _accum = NUM_LIMIT;
+      }
+    }
+    else
+    {
+      _state = ST_NUM_DONE;
+    }
+    break;
+
+  case ST_V:
+    _state = (c == ' ') ? ST_V_TEXT : ST_JUNK;
+    break;
+
+  case ST_V_TEXT:
+    if (_textStart == 0 && !space)
+    {
+      _textStart = _length - 1;
+    }
+    break;
+
+  case ST_SINGLE:
+    if (!space)
+    {
+      _state = ST_JUNK;
+    }
+    break;
+
+  case ST_TAG:
+    if (c >= '0' && c <= '9' && _accum < 256)
+    {
+      _accum = (_accum < 0 ? 0 : _accum * 10) + (c - '0');
+      _seq = (uint8_t)_accum;
+    }
+    else if (c == ' ' && _accum >= 0 && _accum < 256)
+    {
+      // The command itself follows the tag
+      _accum = 0;
+      _state = ST_START;
+    }
+    else
+    {
+      // Not a usable tag, the line is plain junk
+      _tagged = false;
+      _state = ST_JUNK;
+    }
+    break;
+
+  default: // ST_NUM_DONE, ST_JUNK
+    break;
+  }
+
+  return false;
+}
+
+void CommandParser::finishLine()
+{
+  uint8_t state = _state;
+  uint8_t textStart = _textStart;
+  char field = _field;
+  int value = (int)(_negative ? -_accum : _accum);
+  bool hasArg = _hasArg;
+  uint8_t trimmed = _trimmed;
+
+  restart();
+  _type = CMD_NONE;
+  if (state == ST_START && !_tagged)
+  {
+    return; // blank line
+  }
+
+  // Keep the trimmed line around for the accessors
+  _line[trimmed] = '\0';
+
+  if (state == ST_TAG || state == ST_START)
+  {
+    // "#12" with no command: nothing to ack, so not a tagged line either
+    _tagged = false;
+    _seq = 0;
+  }
+
+  switch (state)
+  {
+  case ST_NUM_SPACE:
+  case ST_NUM:
+  case ST_NUM_DONE:
+    if (!hasArg)
+    {
+      break; // "S T" followed by nothing but whitespace
+    }
+    _type = field == 'C' ? CMD_CHANNEL : CMD_STAT;
+    _field = field;
+    _value = value;
+    return;
+
+  case ST_V_TEXT:
+    if (textStart == 0)
+    {
+      break; // "V" followed by nothing but whitespace
+    }
+    if (trimmed - textStart > PARSER_MAX_VOICE)
+    {
+      _line[textStart + PARSER_MAX_VOICE] = '\0';
+    }
+    _type = CMD_VOICE;
+    _textStart = textStart;
+    return;
+
+  case ST_SINGLE:
+    switch (field)
+    {
+    case 'H':
+      _type = CMD_HEALTHY;
+      break;
+    case 'U':
+      _type = CMD_UNHEALTHY;
+      break;
+    case 'B':
+      _type = CMD_BINARY;
+      break;
+    case 'O':
+      _type = CMD_OVERVIEW;
+      break;
+    case 'R':
+      _type = CMD_RESYNC;
+      break;
+    default:
+      _type = CMD_PROFILE;
+      break;
+    }
+    return;
+
+  default:
+    break;
+  }
+
+  _type = CMD_UNKNOWN;
+}
@@ -0,0 +1,94 @@
+/**
+ * Zero-heap serial command parser for the Uno LCD.
+ *
+ * Bytes are fed one at a time and tokenized by a small state machine as
+ * they arrive, so a complete line is already parsed when its '\n' shows up.
+ * The only storage is a fixed line buffer inside the parser (used for the
+ * "ERR Unknown" echo and the voice text); nothing touches the heap.
+ *
+ * Accepted lines (leading/trailing whitespace is ignored):
+ *   S T <int>  - temperature      S H <int> - humidity    S M <int> - moisture
+ *   S<ch> T <int> ...             - the same for channel (plant) ch, e.g. "S3 T 23"
+ *   V <text>   - voice text (truncated to PARSER_MAX_VOICE chars)
+ *   H / U      - healthy / unhealthy screen
+ *   C <ch>     - show one channel      O - overview of all channels
+ *   P          - profile report
+ *   B          - switch to binary frames (lib/BinaryFrame)
+ *   R          - the next tagged command starts a new sequence
+ *
+ * Any of them may be tagged with a sequence number for windowed acks:
+ *   #<seq> <command>   e.g. "#12 S T 23" (seq 0-255)
+ * A tag with nothing after it is an untagged unknown line.
+ *
+ * Numbers follow toInt() rules: optional sign, digits, anything after them is
+ * ignored. Lines longer than PARSER_MAX_LINE chars are discarded and
+ * parsing restarts from the next byte, like the old String buffer did.
+ */
+
+#ifndef COMMAND_PARSER_H
+#define COMMAND_PARSER_H
+
+#include <stdint.h>
+
+#define PARSER_MAX_LINE 64
+#define PARSER_MAX_VOICE 20
+
+enum CommandType : uint8_t
+{
+  CMD_NONE,
+  CMD_STAT,      // field() is 'T', 'H' or 'M', value() the reading, channel() the plant
+  CMD_VOICE,     // text() is the voice text
+  CMD_HEALTHY,
+  CMD_UNHEALTHY,
+  CMD_PROFILE,
+  CMD_BINARY,
+  CMD_CHANNEL,   // value() is the channel to show
+  CMD_OVERVIEW,
+  CMD_RESYNC,
+  CMD_UNKNOWN    // line() is the offending line
+};
+
+class CommandParser
+{
+public:
+  CommandParser();
+
+  // Feed one received byte. Returns true when a non-empty line completed;
+  // the accessors below then describe it until the next call to feed().
+  bool feed(char c);
+  void reset();
+
+  CommandType type() const { return _type; }
+  char field() const { return _field; }
+  int value() const { return _value; }
+  uint8_t channel() const { return _channel; }
+  const char *text() const { return _line + _textStart; }
+  const char *line() const { return _line; }
+  bool tagged() const { return _tagged; }
+  uint8_t seq() const { return _seq; }
+
+private:
+  void restart();
+  void startLine();
+  void finishLine();
+
+  uint8_t _state;
+  uint8_t _count;     // raw chars in the current line (for the length cap)
+  uint8_t _length;    // chars stored in _line (leading whitespace skipped)
+  uint8_t _trimmed;   // _length without trailing whitespace
+  uint8_t _textStart; // voice text offset in _line
+  bool _negative;
+  bool _hasArg;       // something other than whitespace followed "S x "
+  bool _tagged;       // line started with "#<seq> "
+  uint8_t _seq;
+  uint8_t _channel;   // "S<ch>", 0 when left out
+
+  CommandType _type;
+  char _field;
+  int32_t _accum;
+  int _value;
+
+  char _line[PARSER_MAX_LINE + 1];
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "MoistureClassifier.h"
+
+MoistureClassifier::MoistureClassifier(const MoistureConfig &config)
+    : _config(config),
+      _ema(0),
+      _primed(false),
+      _level(MOIST_UNKNOWN),
+      _changedAt(0),
+      _holding(false),
+      _transitions(0),
+      _suppressed(0)
+{
+}
+
+// Level for a value; with a margin the value has to clear each threshold of
+// `level` by that much to count as a different level
+MoistureLevel MoistureClassifier::classify(MoistureLevel level, int16_t value, int16_t margin) const
+{
+  int16_t bad = _config.badBelow;
+  int16_t good = _config.goodAbove;
+
+  // Move the thresholds away from the current level
+  if (level == MOIST_BAD)
+  {
+    bad += margin;
+    good += margin;
+  }
+  else if (level == MOIST_GOOD)
+  {
+    bad -= margin;
+    good -= margin;
+  }
+  else
+  {
+    bad -= margin;
+    good += margin;
+  }
+
+  if (value > good)
+  {
+    return MOIST_GOOD;
+  }
+  if (value >= bad)
+  {
+    return MOIST_AVERAGE;
+  }
+  return MOIST_BAD;
+}
+
+bool MoistureClassifier::update(int16_t raw, unsigned long now)
+{
+  if (!_primed)
+  {
+    _primed = true;
+    _ema = (int32_t)raw << EMA_FRACTION;
+    _level = classify(_level, raw, 0);
+    _changedAt = now;
+    return true;
+  }
+
+  _ema += (((int32_t)raw << EMA_FRACTION) - _ema) >> _config.emaShift;
+
+  MoistureLevel target = classify(_level, filtered(), _config.hysteresis);
+  bool rawDiffers = classify(_level, raw, 0) != _level;
+
+  if (target != _level && now - _changedAt >= _config.dwellMs)
+  {
+    _level = target;
+    _changedAt = now;
+    _holding = false;
+    _transitions++;
+    return true;
+  }
+
+  // Count each excursion the unfiltered thresholds would have acted on once
+  if (rawDiffers && !_holding)
+  {
+    _suppressed++;
+  }
+  _holding = rawDiffers;
+  return false;
+}
+
+void MoistureClassifier::resetCounters()
+{
+  _transitions = 0;
+  _suppressed = 0;
+}
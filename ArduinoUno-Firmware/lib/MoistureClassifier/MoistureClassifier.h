@@ -0,0 +1,73 @@
+/**
+ * Moisture classification for the mood screens and the MOIST label.
+ *
+ * Raw probe readings are smoothed with an EMA, then mapped to BAD / AVERAGE /
+ * GOOD with a hysteresis band around each threshold and a minimum dwell time
+ * between level changes. A noisy probe sitting on a threshold therefore
+ * stays on one level instead of flipping the whole screen every sample.
+ *
+ * The level is MOIST_UNKNOWN until the first reading, which sets it
+ * directly. Excursions that the raw
+ * thresholds alone would have turned into a level change, but that the
+ * filter, band or dwell held back, are counted in suppressed().
+ *
+ * band() applies the same thresholds and hysteresis to a level kept
+ * elsewhere, without the filter state, for plants that only need a level
+ * and no classifier of their own.
+ */
+
+#ifndef MOISTURE_CLASSIFIER_H
+#define MOISTURE_CLASSIFIER_H
+
+#include <stdint.h>
+
+enum MoistureLevel : uint8_t
+{
+  MOIST_BAD,
+  MOIST_AVERAGE,
+  MOIST_GOOD,
+  MOIST_UNKNOWN // no reading yet
+};
+
+struct MoistureConfig
+{
+  int16_t badBelow;       // BAD under this
+  int16_t goodAbove;      // GOOD over this, AVERAGE in between
+  int16_t hysteresis;     // how far past a threshold the average has to go
+  uint8_t emaShift;       // each reading moves the average 1/2^n of the way
+  unsigned long dwellMs;  // minimum time between level changes
+};
+
+class MoistureClassifier
+{
+public:
+  MoistureClassifier(const MoistureConfig &config);
+
+  // Feed a raw reading; returns true if level() changed
+  bool update(int16_t raw, unsigned long now);
+
+  MoistureLevel level() const { return _level; }
+  // Next level for a reading, given the current one (hysteresis only)
+  MoistureLevel band(MoistureLevel current, int16_t raw) const { return classify(current, raw, _config.hysteresis); }
+  MoistureLevel levelOf(int16_t raw) const { return classify(MOIST_BAD, raw, 0); }
+  int16_t filtered() const { return (int16_t)(_ema >> EMA_FRACTION); }
+  uint16_t transitions() const { return _transitions; }
+  uint16_t suppressed() const { return _suppressed; }
+  void resetCounters();
+
+private:
+  static const uint8_t EMA_FRACTION = 4; // fixed-point bits of _ema
+
+  MoistureLevel classify(MoistureLevel level, int16_t value, int16_t margin) const;
+
+  MoistureConfig _config;
+  int32_t _ema;
+  bool _primed;
+  MoistureLevel _level;
+  unsigned long _changedAt;
+  bool _holding; // the raw reading disagrees with the level right now
+  uint16_t _transitions;
+  uint16_t _suppressed;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "TextLayout.h"
+
+#include <string.h>
+
+// Pixel width of a span: words at charW per character, one gap per run of spaces
+static int16_t spanWidth(const char *text, uint8_t length, const LayoutBox &box)
+{
+  int16_t width = 0;
+
+  for (uint8_t i = 0; i < length; i++)
+  {
+    if (text[i] != ' ')
+    {
+      width += box.charW;
+    }
+    else if (i > 0 && text[i - 1] != ' ')
+    {
+      width += box.gap;
+    }
+  }
+  return width;
+}
+
+void layoutText(const char *text, const LayoutBox &box, TextLayout &layout)
+{
+  uint8_t maxLines = box.maxLines < LAYOUT_MAX_LINES ? box.maxLines : LAYOUT_MAX_LINES;
+  uint8_t perLine = box.width / box.charW; // longest unbroken word
+  uint8_t pos = 0;
+
+  layout.text = text;
+  layout.box = box;
+  layout.lineCount = 0;
+  layout.truncated = false;
+
+  if (perLine == 0)
+  {
+    return;
+  }
+
+  while (true)
+  {
+    while (text[pos] == ' ')
+    {
+      pos++;
+    }
+    if (text[pos] == '\0')
+    {
+      break;
+    }
+    if (layout.lineCount == maxLines)
+    {
+      layout.truncated = true;
+      break;
+    }
+
+    uint8_t start = pos;
+    uint8_t end = pos; // end of the last word that fits
+    int16_t x = 0;
+
+    while (text[pos] != '\0')
+    {
+      uint8_t wordStart = pos;
+      while (text[pos] != ' ' && text[pos] != '\0')
+      {
+        pos++;
+      }
+      int16_t w = (pos - wordStart) * box.charW;
+
+      if (end == start)
+      {
+        if (w > box.width)
+        {
+          // Too long for any line: break it
+          pos = wordStart + perLine;
+          end = pos;
+          break;
+        }
+        x = w;
+      }
+      else if (x + box.gap + w <= box.width)
+      {
+        x += box.gap + w;
+      }
+      else
+      {
+        pos = wordStart; // starts the next line
+        break;
+      }
+      end = pos;
+
+      while (text[pos] == ' ')
+      {
+        pos++;
+      }
+    }
+
+    layout.start[layout.lineCount] = start;
+    layout.length[layout.lineCount] = end - start;
+    layout.lineCount++;
+  }
+
+  if (layout.truncated)
+  {
+    // Make room for the ellipsis on the last line
+    uint8_t last = layout.lineCount - 1;
+    const char *line = text + layout.start[last];
+    uint8_t length = layout.length[last];
+    int16_t ellipsisW = LAYOUT_ELLIPSIS_LEN * box.charW;
+
+    while (length > 0 && (spanWidth(line, length, box) + ellipsisW > box.width || line[length - 1] == ' '))
+    {
+      length--;
+    }
+    layout.length[last] = length;
+  }
+}
+
+LayoutCache::LayoutCache()
+    : _next(0)
+{
+  memset(_entries, 0, sizeof(_entries));
+}
+
+const TextLayout &LayoutCache::get(const char *text, const LayoutBox &box)
+{
+  for (uint8_t i = 0; i < LAYOUT_CACHE_SIZE; i++)
+  {
+    TextLayout &entry = _entries[i];
+    if (entry.text == text && entry.box.width == box.width && entry.box.maxLines == box.maxLines &&
+        entry.box.charW == box.charW && entry.box.gap == box.gap)
+    {
+      return entry;
+    }
+  }
+
+  TextLayout &entry = _entries[_next];
+  _next = (_next + 1) % LAYOUT_CACHE_SIZE;
+  layoutText(text, box, entry);
+  return entry;
+}
+
+void LayoutCache::forget(const char *text)
+{
+  for (uint8_t i = 0; i < LAYOUT_CACHE_SIZE; i++)
+  {
+    if (_entries[i].text == text)
+    {
+      _entries[i].text = NULL;
+    }
+  }
+}
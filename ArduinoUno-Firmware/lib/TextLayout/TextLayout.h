@@ -0,0 +1,61 @@
+/**
+ * Word-wrap layout for fixed-width text (the built-in 5x7 GFX font).
+ *
+ * With a fixed-width font, line breaks are plain arithmetic on character
+ * counts, so no getTextBounds() call or word copy is needed. layoutText()
+ * splits a message into line spans once; the renderer then only emits them.
+ * Words wider than a line are broken. Text that needs more lines than the
+ * box holds is cut on the last line, which then ends in LAYOUT_ELLIPSIS.
+ *
+ * LayoutCache keeps the last few layouts keyed by (text pointer, box), so
+ * a message is laid out once however many slices draw it. A buffer whose
+ * contents change (the voice text, the mood message copied out of PROGMEM)
+ * must be forget()-ed.
+ */
+
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include <stdint.h>
+
+#define LAYOUT_MAX_LINES 4
+#define LAYOUT_CACHE_SIZE 2 // the mood message and the voice text
+#define LAYOUT_ELLIPSIS "..."
+#define LAYOUT_ELLIPSIS_LEN 3
+
+// Where the text goes, in pixels
+struct LayoutBox
+{
+  int16_t width;    // usable line width
+  uint8_t maxLines; // at most LAYOUT_MAX_LINES
+  uint8_t charW;    // advance per character
+  uint8_t gap;      // space between words
+};
+
+struct TextLayout
+{
+  const char *text; // cache key, with box
+  LayoutBox box;
+  uint8_t lineCount;
+  bool truncated;   // last line is followed by LAYOUT_ELLIPSIS
+  uint8_t start[LAYOUT_MAX_LINES];  // line spans, offsets into text;
+  uint8_t length[LAYOUT_MAX_LINES]; // spaces inside a span are word gaps
+};
+
+void layoutText(const char *text, const LayoutBox &box, TextLayout &layout);
+
+class LayoutCache
+{
+public:
+  LayoutCache();
+
+  // Cached layout of text in box, laid out now on a miss
+  const TextLayout &get(const char *text, const LayoutBox &box);
+  void forget(const char *text);
+
+private:
+  TextLayout _entries[LAYOUT_CACHE_SIZE];
+  uint8_t _next; // round-robin victim
+};
+
+#endif
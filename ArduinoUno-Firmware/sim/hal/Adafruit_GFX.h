@@ -0,0 +1,60 @@
+/*
+ * Framebuffer display: a 480x320 RGB565 frame in memory (Sim.h), drawn the
+ * way Adafruit_GFX draws it, i.e. text as one fillRect per lit font pixel.
+ * Every pixel and every address window is counted and charged at the
+ * shield's bus rate (pixelNs, windowNs), so render slices take about as
+ * long as on the Uno.
+ */
+
+#ifndef ADAFRUIT_GFX_H
+#define ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+
+class Adafruit_GFX : public Print
+{
+public:
+  Adafruit_GFX()
+      : _cursorX(0), _cursorY(0), _textSize(1), _rotation(0), _textColor(0xFFFF), _textBg(0xFFFF)
+  {
+  }
+
+  void fillScreen(uint16_t color) { fillRect(0, 0, width(), height(), color); }
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { fillRect(x, y, w, 1, color); }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { fillRect(x, y, 1, h, color); }
+  void drawPixel(int16_t x, int16_t y, uint16_t color) { fillRect(x, y, 1, 1, color); }
+  uint16_t readPixel(int16_t x, int16_t y) const;
+
+  void setTextSize(uint8_t size) { _textSize = size ? size : 1; }
+  // Same color twice means a transparent background, as in Adafruit_GFX
+  void setTextColor(uint16_t color) { _textColor = _textBg = color; }
+  void setTextColor(uint16_t color, uint16_t background)
+  {
+    _textColor = color;
+    _textBg = background;
+  }
+  void setCursor(int16_t x, int16_t y)
+  {
+    _cursorX = x;
+    _cursorY = y;
+  }
+  void getTextBounds(const char *s, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h);
+  void setRotation(uint8_t rotation) { _rotation = rotation & 3; }
+  int16_t width() const { return _rotation & 1 ? 480 : 320; }
+  int16_t height() const { return _rotation & 1 ? 320 : 480; }
+
+  size_t write(uint8_t c);
+  using Print::write;
+
+protected:
+  int16_t _cursorX;
+  int16_t _cursorY;
+  uint8_t _textSize;
+  uint8_t _rotation;
+  uint16_t _textColor;
+  uint16_t _textBg;
+};
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * Host stand-in for the AVR Arduino core: just enough for lcd.cpp.
+ * Serial is a pseudo-terminal with the Uno's 64-byte RX buffer and
+ * 115200 baud pacing (see Sim.h).
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+#define strlen_P strlen
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define sprintf_P sprintf
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+
+#define SERIAL_RX_BUFFER_SIZE 64
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+
+typedef uint8_t byte;
+class __FlashStringHelper;
+
+unsigned long millis();
+unsigned long micros();
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+int analogRead(uint8_t pin);
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  size_t write(const uint8_t *buffer, size_t size);
+
+  size_t print(const char *s);
+  size_t print(const __FlashStringHelper *s) { return print(reinterpret_cast<const char *>(s)); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int n, int base = 10) { return print((long)n, base); }
+  size_t print(unsigned int n, int base = 10) { return print((unsigned long)n, base); }
+  size_t print(long n, int base = 10);
+  size_t print(unsigned long n, int base = 10);
+  size_t print(double n, int digits = 2);
+
+  size_t println() { return print("\r\n"); }
+  template <class T>
+  size_t println(T value) { return print(value) + println(); }
+  template <class T>
+  size_t println(T value, int format) { return print(value, format) + println(); }
+};
+
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long baud);
+  int available();
+  int read();
+  int availableForWrite() { return SERIAL_RX_BUFFER_SIZE - 1; }
+  size_t write(uint8_t c);
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif
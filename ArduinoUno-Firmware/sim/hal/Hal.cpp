@@ -0,0 +1,447 @@
+// Standard C++ headers first: Arduino.h defines min/max as macros
+#include <mutex>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+
+#include <Arduino.h>
+#include <MCUFRIEND_kbv.h>
+#include "Sim.h"
+
+HardwareSerial Serial;
+
+//-------------------------------------------------------------------------
+// Clock
+
+uint64_t hostMicros()
+{
+  static timespec start;
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (!start.tv_sec && !start.tv_nsec)
+  {
+    start = now;
+  }
+  return (uint64_t)(now.tv_sec - start.tv_sec) * 1000000 + (now.tv_nsec - start.tv_nsec) / 1000;
+}
+
+unsigned long micros()
+{
+  return (unsigned long)hostMicros();
+}
+
+unsigned long millis()
+{
+  return (unsigned long)(hostMicros() / 1000);
+}
+
+long random(long howbig)
+{
+  return howbig > 0 ? rand() % howbig : 0;
+}
+
+long random(long howsmall, long howbig)
+{
+  return howsmall < howbig ? howsmall + random(howbig - howsmall) : howsmall;
+}
+
+void randomSeed(unsigned long seed)
+{
+  srand(seed);
+}
+
+int analogRead(uint8_t pin)
+{
+  return 512;
+}
+
+//-------------------------------------------------------------------------
+// Print
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--)
+  {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::print(const char *s)
+{
+  return write((const uint8_t *)s, strlen(s));
+}
+
+size_t Print::print(long n, int base)
+{
+  if (base != 10)
+  {
+    return print((unsigned long)n, base);
+  }
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%ld", n);
+  return print(buf);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+  char buf[40];
+  char *p = buf + sizeof(buf) - 1;
+  *p = '\0';
+  if (base < 2)
+  {
+    base = 10;
+  }
+  do
+  {
+    int digit = n % base;
+    *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    n /= base;
+  } while (n);
+  return print(p);
+}
+
+size_t Print::print(double n, int digits)
+{
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return print(buf);
+}
+
+//-------------------------------------------------------------------------
+// Serial: a reader thread takes bytes off the pty as they come and puts
+// them "on the line"; serviceRx() moves the ones that have finished
+// arriving at the baud rate into the 64-byte RX buffer, dropping what does
+// not fit, like the UART ISR on an Uno that is busy drawing
+
+static std::mutex wireLock;
+static std::string wire;          // read from the pty, not yet received
+static uint64_t lineFreeAt = 0;   // when the last byte on the line is in
+static uint8_t rxBuffer[SERIAL_RX_BUFFER_SIZE];
+static uint8_t rxHead = 0;
+static uint8_t rxCount = 0;
+static uint64_t lastPoll = 0;
+
+static uint64_t byteMicros()
+{
+  return 10000000ULL / simConfig.baud; // 8N1
+}
+
+void simStartSerial()
+{
+  std::thread([] {
+    char buf[256];
+    for (;;)
+    {
+      ssize_t n = ::read(simConfig.serialFd, buf, sizeof(buf));
+      if (n <= 0)
+      {
+        usleep(1000); // no peer yet, or it went away
+        continue;
+      }
+      simFeed(buf, n);
+    }
+  }).detach();
+}
+
+void simFeed(const char *data, size_t len)
+{
+  std::lock_guard<std::mutex> guard(wireLock);
+  if (wire.empty())
+  {
+    lineFreeAt = max(lineFreeAt, hostMicros());
+  }
+  wire.append(data, len);
+}
+
+size_t simWirePending()
+{
+  std::lock_guard<std::mutex> guard(wireLock);
+  return wire.size();
+}
+
+static void serviceRx()
+{
+  std::lock_guard<std::mutex> guard(wireLock);
+  uint64_t now = hostMicros();
+  uint64_t byteUs = byteMicros();
+  size_t arrived = 0;
+
+  // How long the firmware left bytes waiting (drawing, mostly)
+  if (lastPoll && (rxCount || !wire.empty()))
+  {
+    simStats.pollGapMaxUs = max(simStats.pollGapMaxUs, now - lastPoll);
+  }
+  lastPoll = now;
+
+  // lineFreeAt is when wire[0] started arriving
+  while (arrived < wire.size() && lineFreeAt + byteUs <= now)
+  {
+    lineFreeAt += byteUs;
+    simStats.rxBytes++;
+    simStats.rxLines += wire[arrived] == '\n';
+    if (rxCount < SERIAL_RX_BUFFER_SIZE - 1)
+    {
+      rxBuffer[(rxHead + rxCount++) % SERIAL_RX_BUFFER_SIZE] = wire[arrived];
+    }
+    else
+    {
+      simStats.rxOverruns++;
+    }
+    arrived++;
+  }
+  wire.erase(0, arrived);
+}
+
+void HardwareSerial::begin(unsigned long baud)
+{
+  simConfig.baud = baud;
+}
+
+int HardwareSerial::available()
+{
+  serviceRx();
+  return rxCount;
+}
+
+int HardwareSerial::read()
+{
+  serviceRx();
+  if (!rxCount)
+  {
+    return -1;
+  }
+  uint8_t c = rxBuffer[rxHead];
+  rxHead = (rxHead + 1) % SERIAL_RX_BUFFER_SIZE;
+  rxCount--;
+  return c;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  simStats.txBytes++;
+  simStats.lastTxUs = hostMicros();
+  if (simConfig.serialFd >= 0 && ::write(simConfig.serialFd, &c, 1) < 0)
+  {
+    // Nobody reading the pty: the byte is lost, like a TX line with no listener
+  }
+  return 1;
+}
+
+//-------------------------------------------------------------------------
+// Display: an RGB565 framebuffer in landscape (rotation 1), the only
+// orientation lcd.cpp uses
+
+static uint16_t frame[SIM_SCREEN_H][SIM_SCREEN_W];
+
+// The classic Adafruit_GFX 5x7 font, ' ' to '~', one byte per column with
+// bit 0 at the top (bit 7 is the descender row)
+static const uint8_t font[95][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x00, 0x60, 0x60, 0x00},
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x00, 0x14, 0x00, 0x00},
+    {0x00, 0x40, 0x34, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06}, {0x3E, 0x41, 0x5D, 0x59, 0x4E},
+    {0x7C, 0x12, 0x11, 0x12, 0x7C}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+    {0x3E, 0x41, 0x41, 0x51, 0x73}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+    {0x7F, 0x02, 0x1C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+    {0x26, 0x49, 0x49, 0x49, 0x32}, {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+    {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F}, {0x04, 0x02, 0x01, 0x02, 0x04},
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40},
+    {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28}, {0x38, 0x44, 0x44, 0x28, 0x7F},
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0x9C, 0x78},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x40, 0x3D, 0x00},
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0xFC, 0x18, 0x24, 0x24, 0x18},
+    {0x18, 0x24, 0x24, 0x18, 0xFC}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},
+    {0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x4C, 0x90, 0x90, 0x90, 0x7C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x77, 0x00, 0x00},
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02}};
+
+// Busy-wait out the drawing time, like the Uno blocked on the bus
+void simDisplayCost(uint32_t pixels, uint32_t windows)
+{
+  uint64_t us = ((uint64_t)pixels * simConfig.pixelNs + (uint64_t)windows * simConfig.windowNs) / 1000;
+  simStats.pixels += pixels;
+  simStats.windows += windows;
+  simStats.displayUs += us;
+
+  uint64_t until = hostMicros() + us;
+  while (hostMicros() < until)
+  {
+  }
+}
+
+bool simDumpFrame(const char *path)
+{
+  FILE *f = fopen(path, "wb");
+  if (!f)
+  {
+    return false;
+  }
+  fprintf(f, "P6\n%d %d\n255\n", SIM_SCREEN_W, SIM_SCREEN_H);
+  for (int y = 0; y < SIM_SCREEN_H; y++)
+  {
+    uint8_t row[SIM_SCREEN_W * 3];
+    for (int x = 0; x < SIM_SCREEN_W; x++)
+    {
+      uint16_t c = frame[y][x];
+      row[3 * x] = (c >> 11) * 255 / 31;
+      row[3 * x + 1] = ((c >> 5) & 0x3F) * 255 / 63;
+      row[3 * x + 2] = (c & 0x1F) * 255 / 31;
+    }
+    fwrite(row, 1, sizeof(row), f);
+  }
+  return fclose(f) == 0;
+}
+
+uint16_t Adafruit_GFX::readPixel(int16_t x, int16_t y) const
+{
+  return (x >= 0 && y >= 0 && x < SIM_SCREEN_W && y < SIM_SCREEN_H) ? frame[y][x] : 0;
+}
+
+// One address window, clipped to the screen like the driver does
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  int16_t x1 = min(x + w, SIM_SCREEN_W);
+  int16_t y1 = min(y + h, SIM_SCREEN_H);
+  x = max(x, 0);
+  y = max(y, 0);
+  if (x >= x1 || y >= y1)
+  {
+    return;
+  }
+
+  for (int16_t r = y; r < y1; r++)
+  {
+    for (int16_t c = x; c < x1; c++)
+    {
+      frame[r][c] = color;
+    }
+  }
+  simDisplayCost((uint32_t)(x1 - x) * (y1 - y), 1);
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+// As Adafruit_GFX::drawChar(): one fillRect per lit pixel (a square of the
+// text size), and per background pixel when a background color is set
+size_t Adafruit_GFX::write(uint8_t c)
+{
+  if (c == '\n')
+  {
+    _cursorX = 0;
+    _cursorY += 8 * _textSize;
+    return 1;
+  }
+  if (c == '\r')
+  {
+    return 1;
+  }
+
+  const uint8_t *glyph = (c >= ' ' && c <= '~') ? font[c - ' '] : font[0];
+  for (int8_t col = 0; col < 6; col++)
+  {
+    uint8_t bits = col < 5 ? glyph[col] : 0;
+    for (int8_t row = 0; row < 8; row++, bits >>= 1)
+    {
+      if (bits & 1 || _textBg != _textColor)
+      {
+        fillRect(_cursorX + col * _textSize, _cursorY + row * _textSize, _textSize, _textSize,
+                 bits & 1 ? _textColor : _textBg);
+      }
+    }
+  }
+  _cursorX += 6 * _textSize;
+  return 1;
+}
+
+void Adafruit_GFX::getTextBounds(const char *s, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w,
+                                 uint16_t *h)
+{
+  *x1 = x;
+  *y1 = y;
+  *w = strlen(s) * 6 * _textSize;
+  *h = 8 * _textSize;
+}
+
+void MCUFRIEND_kbv::setAddrWindow(int16_t x, int16_t y, int16_t x1, int16_t y1)
+{
+  _windowX0 = _writeX = x;
+  _windowY0 = _writeY = y;
+  _windowX1 = x1;
+  _windowY1 = y1;
+  simDisplayCost(0, 1);
+}
+
+void MCUFRIEND_kbv::pushPixel(uint16_t color)
+{
+  if (_writeX >= 0 && _writeY >= 0 && _writeX < SIM_SCREEN_W && _writeY < SIM_SCREEN_H)
+  {
+    frame[_writeY][_writeX] = color;
+  }
+  if (++_writeX > _windowX1)
+  {
+    _writeX = _windowX0;
+    if (++_writeY > _windowY1)
+    {
+      _writeY = _windowY0;
+    }
+  }
+}
+
+// `first` starts again at the window's corner (the driver resends RAMWR)
+void MCUFRIEND_kbv::pushColors(uint16_t *block, int16_t n, bool first)
+{
+  if (first)
+  {
+    _writeX = _windowX0;
+    _writeY = _windowY0;
+  }
+  for (int16_t i = 0; i < n; i++)
+  {
+    pushPixel(block[i]);
+  }
+  simDisplayCost(n, 0);
+}
+
+void MCUFRIEND_kbv::pushColors(uint8_t *block, int16_t n, bool first)
+{
+  pushColors((const uint8_t *)block, n, first, false);
+}
+
+void MCUFRIEND_kbv::pushColors(const uint8_t *block, int16_t n, bool first, bool bigEndian)
+{
+  if (first)
+  {
+    _writeX = _windowX0;
+    _writeY = _windowY0;
+  }
+  for (int16_t i = 0; i < n; i++)
+  {
+    uint8_t a = block[2 * i];
+    uint8_t b = block[2 * i + 1];
+    pushPixel(bigEndian ? (a << 8) | b : (b << 8) | a);
+  }
+  simDisplayCost(n, 0);
+}
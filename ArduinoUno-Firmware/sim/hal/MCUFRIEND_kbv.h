@@ -0,0 +1,28 @@
+#ifndef MCUFRIEND_KBV_H
+#define MCUFRIEND_KBV_H
+
+#include <Adafruit_GFX.h>
+
+// setAddrWindow()/pushColors() stream into the window row by row, wrapping
+// back to its top-left corner like the ILI9481 does
+
+class MCUFRIEND_kbv : public Adafruit_GFX
+{
+public:
+  void reset() {}
+  void begin(uint16_t id) {}
+  uint16_t readID() { return 0x9481; }
+  void setAddrWindow(int16_t x, int16_t y, int16_t x1, int16_t y1);
+  void pushColors(uint16_t *block, int16_t n, bool first);
+  void pushColors(uint8_t *block, int16_t n, bool first);
+  void pushColors(const uint8_t *block, int16_t n, bool first, bool bigEndian = false);
+  void vertScroll(int16_t top, int16_t scrollLines, int16_t offset) {}
+
+private:
+  void pushPixel(uint16_t color);
+
+  int16_t _windowX0, _windowY0, _windowX1, _windowY1;
+  int16_t _writeX, _writeY; // next pixel of the window
+};
+
+#endif
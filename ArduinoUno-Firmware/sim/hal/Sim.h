@@ -0,0 +1,45 @@
+/*
+ * Knobs and counters shared by the Uno HAL and sim_main.cpp.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct SimConfig
+{
+  int serialFd;          // pseudo-terminal master, -1 before it is open
+  uint32_t baud;         // bytes reach the RX buffer no faster than this
+  uint32_t pixelNs;      // display time per pixel written
+  uint32_t windowNs;     // display time per address window (command bytes)
+};
+
+struct SimStats
+{
+  uint32_t rxBytes;
+  uint32_t rxOverruns;   // bytes lost to a full 64-byte RX buffer
+  uint32_t txBytes;
+  uint32_t rxLines;      // newlines received
+  uint64_t pixels;
+  uint64_t windows;      // address windows set (one per fillRect, per line of drawRect...)
+  uint64_t displayUs;    // time spent "drawing"
+  uint64_t pollGapMaxUs; // longest time Serial went unread while bytes were waiting
+  uint64_t lastTxUs;     // when the last reply byte went out
+};
+
+#define SIM_SCREEN_W 480
+#define SIM_SCREEN_H 320
+
+extern SimConfig simConfig;
+extern SimStats simStats;
+
+void simDisplayCost(uint32_t pixels, uint32_t windows);
+void simStartSerial();  // reader thread for serialFd
+void simFeed(const char *data, size_t len); // bytes "sent by the host", at the baud rate
+size_t simWirePending();                    // bytes fed but not received yet
+bool simDumpFrame(const char *path);        // framebuffer as a binary PPM
+uint64_t hostMicros();
+
+#endif
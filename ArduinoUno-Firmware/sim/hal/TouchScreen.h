@@ -0,0 +1 @@
+// Not used by lcd.cpp yet
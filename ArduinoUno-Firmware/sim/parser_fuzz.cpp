@@ -0,0 +1,427 @@
+/*
+ * Host fuzz check and benchmark for lib/CommandParser.
+ *
+ * Feeds random byte streams (mostly near-miss commands, overlong lines,
+ * stray '\r' and whitespace, after a fixed corpus of edge cases) to the
+ * parser and checks every line it completes against two references:
+ *
+ *   - the String code it replaced: a line completes on the same '\n', and
+ *     anything over 64 chars is dropped and parsing restarts from the next
+ *     byte; "S T/H/M <n>" give the same field and toInt() value, and an
+ *     untagged unknown line echoes the same trimmed text;
+ *   - a plain-string model of the grammar in CommandParser.h, for the
+ *     commands added since: type, tag and seq, channel, field, value,
+ *     voice text and unknown echo must all match.
+ *
+ * Numbers are the one intended difference: the parser saturates at 32767
+ * where toInt() wrapped, so the references saturate too.
+ *
+ * Also checks nothing allocates while the parser runs, and times both.
+ *
+ *   cmake -S sim -B build-sim && cmake --build build-sim
+ *   build-sim/parser_fuzz [--lines N] [--seed S]
+ *
+ * Exits non-zero on the first mismatch or allocation.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <CommandParser.h>
+
+// Every operator new in the process is counted
+static unsigned long allocations = 0;
+
+void *operator new(size_t size)
+{
+  allocations++;
+  void *p = malloc(size ? size : 1);
+  if (!p)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  free(p);
+}
+
+//-------------------------------------------------------------------------
+// The old code: a String grown per byte, trimmed, matched with startsWith()
+
+struct OldLine
+{
+  std::string line; // trimmed
+  char field;       // 'T', 'H', 'M' or 0 for an unknown line
+  int value;
+};
+
+static bool oldSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// toInt(), i.e. atol(): whitespace, sign, digits (saturating, see above)
+static int oldToInt(const char *s)
+{
+  while (oldSpace(*s))
+  {
+    s++;
+  }
+  bool negative = *s == '-';
+  if (*s == '-' || *s == '+')
+  {
+    s++;
+  }
+  long value = 0;
+  while (*s >= '0' && *s <= '9')
+  {
+    value = value * 10 + (*s++ - '0');
+    if (value > 32767)
+    {
+      value = 32767;
+    }
+  }
+  return (int)(negative ? -value : value);
+}
+
+static void oldReference(const std::string &stream, std::vector<OldLine> &out)
+{
+  std::string buffer;
+  for (char c : stream)
+  {
+    if (c == '\n')
+    {
+      size_t start = 0;
+      size_t end = buffer.size();
+      while (start < end && oldSpace(buffer[start]))
+      {
+        start++;
+      }
+      while (end > start && oldSpace(buffer[end - 1]))
+      {
+        end--;
+      }
+      if (end > start)
+      {
+        OldLine line;
+        line.line = buffer.substr(start, end - start);
+        line.field = 0;
+        line.value = 0;
+        const char *s = line.line.c_str();
+        if (!strncmp(s, "S T ", 4) || !strncmp(s, "S H ", 4) || !strncmp(s, "S M ", 4))
+        {
+          line.field = s[2];
+          line.value = oldToInt(s + 4);
+        }
+        out.push_back(line);
+      }
+      buffer.clear();
+    }
+    else if (c != '\r')
+    {
+      buffer += c;
+      if (buffer.size() > 64)
+      {
+        buffer.clear();
+      }
+    }
+  }
+}
+
+//-------------------------------------------------------------------------
+// The grammar, on the trimmed line with plain string operations
+
+struct Expected
+{
+  CommandType type;
+  bool tagged;
+  uint8_t seq;
+  uint8_t channel;
+  char field;
+  int value;
+  std::string text; // voice text
+  std::string line; // echo, whitespace after the tag squeezed out
+};
+
+static bool isDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+// Digits from `at` as a number, 256 for anything bigger than 255
+static int smallNumber(const std::string &s, size_t at, size_t end)
+{
+  int value = 0;
+  for (size_t i = at; i < end; i++)
+  {
+    value = std::min(256, value * 10 + (s[i] - '0'));
+  }
+  return value;
+}
+
+// One command, no tag, no surrounding whitespace
+static void modelCommand(const std::string &cmd, Expected &e)
+{
+  size_t size = cmd.size();
+  char c = cmd[0];
+  if (c == 'S')
+  {
+    size_t at = 1;
+    while (at < size && isDigit(cmd[at]))
+    {
+      at++;
+    }
+    int channel = smallNumber(cmd, 1, at);
+    if (channel <= 255 && size > at + 3 && cmd[at] == ' ' && strchr("THM", cmd[at + 1]) && cmd[at + 2] == ' ')
+    {
+      e.type = CMD_STAT;
+      e.channel = channel;
+      e.field = cmd[at + 1];
+      e.value = oldToInt(cmd.c_str() + at + 3);
+    }
+  }
+  else if (c == 'C' && size > 2 && cmd[1] == ' ')
+  {
+    e.type = CMD_CHANNEL;
+    e.field = 'C';
+    e.value = oldToInt(cmd.c_str() + 2);
+  }
+  else if (c == 'V' && size > 2 && cmd[1] == ' ')
+  {
+    e.type = CMD_VOICE;
+    e.text = cmd.substr(cmd.find_first_not_of(" \t\v\f", 2), PARSER_MAX_VOICE);
+  }
+  else if (size == 1)
+  {
+    const char *singles = "HUPBOR";
+    const CommandType types[] = {CMD_HEALTHY, CMD_UNHEALTHY, CMD_PROFILE, CMD_BINARY, CMD_OVERVIEW, CMD_RESYNC};
+    const char *found = strchr(singles, c);
+    if (c && found)
+    {
+      e.type = types[found - singles];
+    }
+  }
+}
+
+// "#<seq> " (one space, seq 0-255) and a command, or just a command. A tag
+// with no command after it is an untagged unknown line.
+static Expected model(const std::string &line)
+{
+  Expected e = {CMD_UNKNOWN, false, 0, 0, 0, 0, "", line};
+  if (line[0] != '#')
+  {
+    modelCommand(line, e);
+    return e;
+  }
+
+  size_t end = 1;
+  while (end < line.size() && isDigit(line[end]))
+  {
+    end++;
+  }
+  int seq = smallNumber(line, 1, end);
+  if (end == 1 || seq > 255 || end == line.size() || line[end] != ' ')
+  {
+    return e;
+  }
+  std::string cmd = line.substr(line.find_first_not_of(" \t\v\f", end));
+  e.tagged = true;
+  e.seq = seq;
+  e.line = line.substr(0, end + 1) + cmd;
+  modelCommand(cmd, e);
+  return e;
+}
+
+//-------------------------------------------------------------------------
+// Streams
+
+static std::mt19937 rng(1);
+
+static int randomInt(int min, int max)
+{
+  return std::uniform_int_distribution<int>(min, max)(rng);
+}
+
+static const char *const PIECES[] = {"S", "T", "H", "M", " ", "  ", "\t", "\r", "-", "+", "0", "7", "42", "32767",
+                                     "99999", "x", "V", "U", "C", "P", "O", "B", "R", "3", "#", "S T ", "S H ", "S M ",
+                                     "#12", "#12 ", "255", "256", "V "};
+
+// Edge cases every run starts with
+static const char *const CORPUS[] = {
+    "#12",        "#12 ",       "#12 \t ",  "#",          "# H",      "#12\tH",    "#12  H",       "#0 H",
+    "#007 H",     "#255 H",     "#256 H",    "#1000 H",    "#12 #13 H", "#12 x",     "#12 S T",      "#12 S T 5",
+    "S0 T 5",     "S255 M 1",   "S256 M 1",  "S3T 5",      "S T",      "S T -",      "S T +-5",      "S T 99999",
+    "C",          "C 3",        "C x",       "V",          "V ",       "V  x",       "V\tx",         "V 12345678901234567890123",
+    "H x",        "HU",         "R",         "#9 R",       "S T\t5",   "S\tT 5",    "#12 V  hello", "  \t#3 O \t"};
+
+// One line, usually close to a real command, sometimes far over the cap
+static std::string randomLine()
+{
+  std::string line;
+  switch (randomInt(0, 7))
+  {
+  case 0:
+    line = std::string("S ") + "THM"[randomInt(0, 2)] + " " + std::to_string(randomInt(-3000, 40000));
+    break;
+  case 1:
+    line = std::string(randomInt(0, 80), ' ') + "S M " + std::to_string(randomInt(0, 4095));
+    break;
+  case 2:
+    line = std::string(randomInt(50, 140), 'x');
+    break;
+  case 3:
+    line = "#" + std::to_string(randomInt(0, 300)) + (randomInt(0, 3) ? " " : "");
+    break;
+  case 4:
+    line = std::string("S") + std::to_string(randomInt(0, 20)) + " " + "THM"[randomInt(0, 2)] + " ";
+    break;
+  default:
+    break;
+  }
+  for (int n = randomInt(0, 12); n > 0; n--)
+  {
+    line += PIECES[randomInt(0, sizeof(PIECES) / sizeof(PIECES[0]) - 1)];
+  }
+  return line + (randomInt(0, 3) ? "\n" : "\r\n");
+}
+
+static bool matches(const CommandParser &parser, const Expected &want)
+{
+  if (parser.type() != want.type || parser.tagged() != want.tagged || (want.tagged && parser.seq() != want.seq))
+  {
+    return false;
+  }
+  switch (want.type)
+  {
+  case CMD_STAT:
+    return parser.channel() == want.channel && parser.field() == want.field && parser.value() == want.value;
+  case CMD_CHANNEL:
+    return parser.value() == want.value;
+  case CMD_VOICE:
+    return want.text == parser.text();
+  case CMD_UNKNOWN:
+    return want.line == parser.line();
+  default:
+    return true;
+  }
+}
+
+//-------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+  int lines = 200000;
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    if (!strcmp(argv[i], "--lines"))
+    {
+      lines = atoi(argv[i + 1]);
+    }
+    else if (!strcmp(argv[i], "--seed"))
+    {
+      rng.seed(atoi(argv[i + 1]));
+    }
+  }
+
+  std::string stream;
+  for (const char *line : CORPUS)
+  {
+    stream += line;
+    stream += '\n';
+  }
+  for (int i = 0; i < lines; i++)
+  {
+    stream += randomLine();
+  }
+
+  std::vector<OldLine> expected;
+  expected.reserve(lines);
+  auto start = std::chrono::steady_clock::now();
+  oldReference(stream, expected);
+  double oldNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  // The check: parse everything, compare each completed line
+  CommandParser parser;
+  size_t next = 0;
+  unsigned long parserAllocations = 0; // the model allocates, the parser must not
+  for (size_t i = 0; i < stream.size(); i++)
+  {
+    unsigned long before = allocations;
+    bool completed = parser.feed(stream[i]);
+    parserAllocations += allocations - before;
+    if (!completed)
+    {
+      continue;
+    }
+    if (next == expected.size())
+    {
+      fprintf(stderr, "[Fuzz] byte %zu: extra line \"%s\"\n", i, parser.line());
+      return 1;
+    }
+
+    const OldLine &old = expected[next++];
+    Expected want = model(old.line);
+    CommandType type = parser.type();
+    bool match = matches(parser, want);
+    if (old.field)
+    {
+      match = match && type == CMD_STAT && parser.field() == old.field && parser.value() == old.value &&
+              parser.channel() == 0 && !parser.tagged();
+    }
+    if (type == CMD_UNKNOWN && !parser.tagged())
+    {
+      match = match && old.line == parser.line();
+    }
+    if (!match)
+    {
+      fprintf(stderr,
+              "[Fuzz] line %zu \"%s\": expected type %d tag %d/%u ch %u %c %d \"%s\", "
+              "parser type %d tag %d/%u ch %u %c %d \"%s\"\n",
+              next - 1, old.line.c_str(), want.type, want.tagged, want.seq, want.channel,
+              want.field ? want.field : '?', want.value, want.text.c_str(), type, parser.tagged(), parser.seq(),
+              parser.channel(), parser.field() ? parser.field() : '?', parser.value(),
+              type == CMD_VOICE ? parser.text() : parser.line());
+      return 1;
+    }
+  }
+  if (next != expected.size())
+  {
+    fprintf(stderr, "[Fuzz] parser completed %zu lines, old code %zu\n", next, expected.size());
+    return 1;
+  }
+  if (parserAllocations)
+  {
+    fprintf(stderr, "[Fuzz] parser allocated %lu times\n", parserAllocations);
+    return 1;
+  }
+
+  // The benchmark: the parser alone over the same stream
+  volatile unsigned completed = 0;
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < stream.size(); i++)
+  {
+    completed += parser.feed(stream[i]);
+  }
+  double newNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  printf("[Fuzz] %d lines, %zu bytes: %zu completed, all match the references\n", lines, stream.size(),
+         expected.size());
+  printf("[Fuzz] parser %.2f ns/byte, 0 allocations; String code %.2f ns/byte\n", newNs / stream.size(),
+         oldNs / stream.size());
+  return 0;
+}
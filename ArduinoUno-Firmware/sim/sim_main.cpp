@@ -0,0 +1,269 @@
+/*
+ * Host build of the Uno LCD firmware (src/lcd.cpp) on a pseudo-terminal.
+ *
+ * lcd.cpp runs unchanged against hal/: Serial is the pty, with the Uno's
+ * 64-byte RX buffer filled at 115200 baud (bytes that do not fit are
+ * dropped, like a real overrun), and a 480x320 framebuffer that takes as
+ * long to draw as the shield. Anything that talks the serial protocol can
+ * drive it: server/lcd_bench.py, the SerialBridge, or the ESP32 host
+ * build's direct link (ESP32-Firmware/sim, --uno). --replay feeds a script
+ * of protocol lines itself, as fast as the line allows, and exits once the
+ * firmware has gone quiet: a repeatable benchmark with no other process.
+ *
+ *   cmake -S sim -B build-sim && cmake --build build-sim
+ *   build-sim/lcd_sim --link /tmp/uno-tty
+ *
+ * Options:
+ *   --link PATH       also make the pty reachable as PATH (a symlink)
+ *   --duration S      stop after S seconds (default: run until killed)
+ *   --pixel-ns N      display time per pixel (300, about the shield's fill rate)
+ *   --window-ns N     display time per address window (3000)
+ *   --replay FILE     send FILE's lines (blank lines and "#" comments skipped)
+ *   --repeat N        ... N times over (default 1)
+ *   --dump PREFIX     write the screen to PREFIX-final.ppm at exit, and to
+ *                     PREFIX-NNNN.ppm on SIGUSR1
+ *   --dump-every S    ... and every S seconds
+ *
+ * Prints the pty name at start and the serial and display counters at exit.
+ */
+
+#include <string>
+
+#include <Arduino.h>
+#include "hal/Sim.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+
+void setup();
+void loop();
+extern bool seqKnown;
+extern uint8_t expectedSeq;
+
+SimConfig simConfig = {-1, 115200, 300, 3000};
+SimStats simStats;
+
+static volatile sig_atomic_t stopping = 0;
+static volatile sig_atomic_t dumpRequested = 0;
+static const char *linkPath = NULL;
+static const char *dumpPrefix = NULL;
+static unsigned dumpCount = 0;
+
+static void onSignal(int)
+{
+  stopping = 1;
+}
+
+static void onDumpSignal(int)
+{
+  dumpRequested = 1;
+}
+
+static void dumpFrame(const char *suffix)
+{
+  char path[256];
+  if (suffix)
+  {
+    snprintf(path, sizeof(path), "%s-%s.ppm", dumpPrefix, suffix);
+  }
+  else
+  {
+    snprintf(path, sizeof(path), "%s-%04u.ppm", dumpPrefix, dumpCount++);
+  }
+  if (!simDumpFrame(path))
+  {
+    perror("[Sim] dump");
+  }
+}
+
+// The script's protocol lines, once per repeat, newline-terminated
+static std::string loadReplay(const char *path, int repeat)
+{
+  FILE *f = fopen(path, "r");
+  if (!f)
+  {
+    perror("[Sim] replay");
+    exit(1);
+  }
+
+  std::string script;
+  char line[256];
+  while (fgets(line, sizeof(line), f))
+  {
+    line[strcspn(line, "\r\n")] = 0;
+    if (line[0] && line[0] != '#')
+    {
+      script += line;
+      script += '\n';
+    }
+  }
+  fclose(f);
+
+  std::string all;
+  for (int i = 0; i < repeat; i++)
+  {
+    all += script;
+  }
+  return all;
+}
+
+static void usage()
+{
+  fprintf(stderr, "usage: lcd_sim [--link PATH] [--duration S] [--pixel-ns N] [--window-ns N]\n"
+                  "               [--replay FILE [--repeat N]] [--dump PREFIX [--dump-every S]]\n");
+  exit(2);
+}
+
+// Master side for the firmware; the slave is raw 8-bit, no echo
+static const char *openPty()
+{
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+  {
+    perror("[Sim] pty");
+    exit(1);
+  }
+  const char *name = ptsname(master);
+
+  // Keep the slave open ourselves so the master never sees a hangup
+  // between peers, and set it raw once for whoever opens it next
+  int slave = open(name, O_RDWR | O_NOCTTY);
+  termios tio;
+  if (slave < 0 || tcgetattr(slave, &tio) != 0)
+  {
+    perror("[Sim] pty slave");
+    exit(1);
+  }
+  cfmakeraw(&tio);
+  tcsetattr(slave, TCSANOW, &tio);
+
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+  simConfig.serialFd = master;
+  return name;
+}
+
+int main(int argc, char **argv)
+{
+  double duration = 0;
+  double dumpEvery = 0;
+  const char *replayPath = NULL;
+  int repeat = 1;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (i + 1 >= argc)
+    {
+      usage();
+    }
+    if (strcmp(argv[i], "--link") == 0)
+    {
+      linkPath = argv[++i];
+    }
+    else if (strcmp(argv[i], "--duration") == 0)
+    {
+      duration = atof(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--pixel-ns") == 0)
+    {
+      simConfig.pixelNs = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--window-ns") == 0)
+    {
+      simConfig.windowNs = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--replay") == 0)
+    {
+      replayPath = argv[++i];
+    }
+    else if (strcmp(argv[i], "--repeat") == 0)
+    {
+      repeat = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "--dump") == 0)
+    {
+      dumpPrefix = argv[++i];
+    }
+    else if (strcmp(argv[i], "--dump-every") == 0)
+    {
+      dumpEvery = atof(argv[++i]);
+    }
+    else
+    {
+      usage();
+    }
+  }
+
+  const char *name = openPty();
+  if (linkPath)
+  {
+    unlink(linkPath);
+    if (symlink(name, linkPath) != 0)
+    {
+      perror("[Sim] link");
+      exit(1);
+    }
+  }
+  fprintf(stderr, "[Sim] Uno serial on %s%s%s\n", name, linkPath ? " -> " : "", linkPath ? linkPath : "");
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  signal(SIGUSR1, onDumpSignal);
+  simStartSerial();
+
+  setup();
+  std::string script = replayPath ? loadReplay(replayPath, repeat) : "";
+  uint64_t replayStart = hostMicros();
+  simFeed(script.data(), script.size());
+
+  uint64_t nextDump = dumpEvery > 0 ? (uint64_t)(dumpEvery * 1e6) : 0;
+  while (!stopping && (duration <= 0 || hostMicros() < duration * 1e6))
+  {
+    loop();
+    usleep(50); // the real loop() spins; spare the host CPU
+
+    if (dumpPrefix && (dumpRequested || (nextDump && hostMicros() >= nextDump)))
+    {
+      dumpFrame(NULL);
+      dumpRequested = 0;
+      if (nextDump && hostMicros() >= nextDump)
+      {
+        nextDump += (uint64_t)(dumpEvery * 1e6);
+      }
+    }
+
+    // Replay done: everything received and nothing said for half a second
+    if (replayPath && !simWirePending() && !Serial.available() &&
+        hostMicros() - max(simStats.lastTxUs, replayStart) > 500000)
+    {
+      break;
+    }
+  }
+
+  double seconds = hostMicros() / 1e6;
+  fprintf(stderr, "\n[Sim] %.1f s  rx=%u bytes overruns=%u  tx=%u bytes  pixels=%llu windows=%llu  display busy %.1f%%\n",
+          seconds, simStats.rxBytes, simStats.rxOverruns, simStats.txBytes, (unsigned long long)simStats.pixels,
+          (unsigned long long)simStats.windows, simStats.displayUs / 1e4 / seconds);
+  fprintf(stderr, "[Sim] %u lines, longest unread gap %.1f ms\n", simStats.rxLines, simStats.pollGapMaxUs / 1e3);
+  if (seqKnown)
+  {
+    fprintf(stderr, "[Sim] next_seq=%u\n", expectedSeq);
+  }
+  if (replayPath)
+  {
+    // The quiet tail is not part of the run
+    double busy = (max(simStats.lastTxUs, replayStart) - replayStart) / 1e6;
+    fprintf(stderr, "[Sim] replay: %u lines in %.2f s, %.0f lines/s\n", simStats.rxLines, busy,
+            busy > 0 ? simStats.rxLines / busy : 0);
+  }
+  if (dumpPrefix)
+  {
+    dumpFrame("final");
+  }
+  if (linkPath)
+  {
+    unlink(linkPath);
+  }
+  return 0;
+}
@@ -227,6 +227,11 @@
 #include <Adafruit_GFX.h>
 #include <MCUFRIEND_kbv.h>
 #include <TouchScreen.h>
+#include <CommandParser.h>
+#include <BinaryFrame.h>
+#include <BigFont.h>
+#include <TextLayout.h>
+#include <MoistureClassifier.h>
 // Pins
 #define LCD_RD A0
 #define LCD_WR A1
@@ -244,24 +249,385 @@
 #define WHITE 0xFFFF
 MCUFRIEND_kbv tft;
 
-// Current sensor values
-int currentTemp = 0;
-int currentHumid = 0;
-int currentMoist = 0;
+// Serial line parser (fixed buffer, no heap)
+CommandParser parser;
 
-// Serial buffer
-String serialBuffer = "";
+// Binary frames, used instead of text lines once the host sends "B"
+FrameDecoder frames;
+bool binaryMode = false;
+
+// Windowed acks: tagged lines ("#12 S T 23") and binary frames carry a
+// sequence number and get "ACK <seq> <depth>" back instead of "OK ...".
+// Acks are cumulative, so the host can keep a few commands in flight.
+#define ACK_WINDOW 16 // max commands a host keeps in flight
+#define BUSY_DEPTH 4  // queued render jobs before replies turn into BUSY
+#define READY_DEPTH 1 // queue depth that ends a BUSY with "RDY"
+
+bool seqKnown = false;   // set by the first tagged command after a reset
+uint8_t expectedSeq = 0; // next sequence number
+bool busySent = false;   // waiting for the queue to drain to send RDY
 
 // Forward declarations
-void show(uint16_t bgColor, const char *faces[], const char *messages[], int numItems);
+void show(uint16_t bgColor, const char *const faces[], const char *const messages[], int numItems);
 void healthy();
 void unhealthy();
 void stats();
-void handleCommand(const String &line);
-void printWrappedText(const char *text, int boxX, int boxY, int boxW, int boxH);
+void handleCommand(const CommandParser &command);
+void handleFrame(FrameStatus status);
+bool acceptSeq(uint8_t seq);
+void ack(uint8_t seq);
+void nak(uint8_t seq, const __FlashStringHelper *reason);
+void updateChannel(uint8_t ch, uint8_t fields, int temp, int humid, int moist);
+void showChannel(uint8_t ch);
+void showOverview();
+void overview();
+void tiles();
+void messageBox(const char *message);
+void voice(const char *text);
+void requestScreen(uint8_t screen, bool force);
+void markFrame();
+void frame();
+void updateStatValues();
+void invalidateStats();
+void channelLabel();
+void history();
+void recordHistory();
+bool renderSlice();
+void blitGlyph(int16_t x, int16_t y, char c, uint8_t scale, uint16_t color, uint16_t bg);
 // Mood state based on moisture
 bool moistureIsBad = false;
 
+// Moisture levels: smoothed, with hysteresis and a minimum dwell, so a probe
+// reading around a threshold does not repaint the whole screen every sample
+#define MOIST_BAD_BELOW 1000
+#define MOIST_GOOD_ABOVE 2000
+#define MOIST_HYSTERESIS 50
+#define MOIST_EMA_SHIFT 2      // each reading moves the average 1/4 of the way
+#define MOIST_DWELL_MS 10000UL // at least this long between level changes
+
+const MoistureConfig moistureConfig = {MOIST_BAD_BELOW, MOIST_GOOD_ABOVE, MOIST_HYSTERESIS,
+                                       MOIST_EMA_SHIFT, MOIST_DWELL_MS};
+MoistureClassifier moisture(moistureConfig);
+
+// Stats strip: 3 equal boxes at top, kept as retained widgets so an update
+// only repaints the part of the screen that actually changed
+#define NUM_STATS 3
+#define STAT_TEMP 0
+#define STAT_HUMID 1
+#define STAT_MOIST 2
+
+#define STAT_BOX_W 140
+#define STAT_BOX_H 70
+#define STAT_BOX_Y 20
+#define STAT_LABEL_Y (STAT_BOX_Y + 8)
+#define STAT_VALUE_Y (STAT_BOX_Y + 35)
+#define STAT_VALUE_SIZE 3
+#define STAT_VALUE_H (8 * STAT_VALUE_SIZE)
+#define STAT_LABEL_SIZE 2
+#define STAT_CHAR_W (BIGFONT_CELL_W * STAT_VALUE_SIZE) // 5x7 font, 1px spacing
+#define STAT_GLYPHS_PER_SLICE 2 // ~860 px streamed per slice
+
+// Dirty flags
+#define DIRTY_FRAME 0x01 // box fill, outline and label
+#define DIRTY_VALUE 0x02 // value text only
+
+// Per-channel (plant) state, packed to 4 bytes so the whole table costs
+// 64 bytes of SRAM. Values are kept as the screen shows them: whole C, %RH
+// and raw ADC counts. Readings for a channel that is not on screen only
+// write its entry; the tile catches up when its page comes round.
+#define MAX_CHANNELS 16
+#define NO_TEMP -128   // no temperature yet
+#define NO_HUMID 127   // no humidity yet
+#define MOIST_MAX 4095 // 12-bit ADC
+
+struct ChannelState
+{
+  int8_t temp;           // C, NO_TEMP until the first reading
+  uint8_t humid : 7;     // %RH, NO_HUMID until the first reading
+  uint8_t hasMoist : 1;
+  uint16_t moist : 12;   // raw ADC counts
+  uint16_t level : 2;    // MoistureLevel
+  uint16_t dirty : 2;    // tile DIRTY_* flags
+};
+
+ChannelState channels[MAX_CHANNELS];
+uint16_t channelsSeen = 0; // bit per channel that has reported
+uint8_t shownChannel = 0;  // channel of the detail view and the classifier
+
+// Views: one plant with its mood screen, or tiles of up to 8 plants a page.
+// Unless the host picks a view ("C <ch>" / "O"), the first reading from a
+// second plant switches to the overview.
+#define MODE_DETAIL 0
+#define MODE_OVERVIEW 1
+#define AUTO_OVERVIEW 1
+
+#define TILE_COLS 4
+#define TILE_W 120
+#define TILE_H 160
+#define TILES_PER_PAGE 8
+#define PAGES (MAX_CHANNELS / TILES_PER_PAGE)
+#define PAGE_MS 8000UL // time on each page that has plants
+
+#define TILE_TEXT_SIZE 3
+#define TILE_TEXT_X 15        // 5 cells centered in the tile
+#define TILE_LABEL_SIZE 2
+#define TILE_LABEL_Y 12
+#define TILE_LINE_Y 44        // first value line
+#define TILE_LINE_H 36
+#define TILE_LINES 4          // label, temperature, humidity, moisture
+
+uint8_t viewMode = MODE_DETAIL;
+bool viewChosen = false;  // set by the host, turns AUTO_OVERVIEW off
+bool viewChanged = false; // the next frame draws the view from scratch
+uint8_t page = 0;
+unsigned long pageShownAt = 0;
+
+// "#12" under the face when there is more than one plant
+char labelText[5];
+
+// History strip under the face and message boxes: the shown plant's
+// readings over the last HISTORY_LEN x HISTORY_MS, drawn as a sweep chart.
+// Ring slot i is always screen column i, so a new sample costs its own
+// column plus clearing the cursor column after it, and nothing is shifted.
+// (The ILI9481's hardware scroll moves whole panel rows, which in landscape
+// are full-height columns, so it would move the mood screen with the strip.)
+//
+// Memory: NUM_METRICS x HISTORY_LEN = 264 bytes, each reading quantized to
+// 1-255 over a fixed range, 0 for none.
+// Draw cost per sample: 3 columns of 5x36 px (the new one, the cursor and
+// the oldest) plus their line segments, at most ~1100 px, i.e. one render
+// slice. After the screen was cleared the
+// strip is repainted HISTORY_COLS_PER_SLICE columns a slice (11 slices).
+#define HISTORY_LEN 88
+#define HISTORY_MS 60000UL // one column a minute, ~1.5 h across
+#define HISTORY_X 20
+#define HISTORY_Y 278
+#define HISTORY_COL_W 5
+#define HISTORY_H 36
+#define HISTORY_COLS_PER_SLICE 8
+#define HISTORY_BG BLACK
+
+#define METRIC_TEMP 0
+#define METRIC_HUMID 1
+#define METRIC_MOIST 2
+#define NUM_METRICS 3
+
+struct HistoryMetric
+{
+  int16_t low;  // bottom of the strip
+  int16_t high; // top
+  uint16_t color;
+};
+
+const HistoryMetric historyMetrics[NUM_METRICS] = {
+    {0, 50, MAGENTA},      // C
+    {0, 100, CYAN},        // %RH
+    {0, MOIST_MAX, GREEN}}; // ADC counts
+
+uint8_t historySamples[NUM_METRICS][HISTORY_LEN];
+uint8_t historyHead = 0;    // next slot, shown as the cursor
+uint8_t historyDrawn = 0;   // slots before this one are on screen
+bool historyInvalid = true; // the whole strip needs a repaint
+unsigned long historyAt = 0;
+
+struct StatWidget
+{
+  int16_t x;         // left edge of the box
+  PGM_P label;
+  int8_t labelX;     // label offset inside the box
+  char value[8];     // text that should be on screen
+  uint16_t color;    // value text color
+  uint8_t dirty;
+  int16_t drawnX;    // damage rect of the value currently on screen
+  int16_t drawnW;    // (0 = nothing drawn)
+};
+
+const char tempLabel[] PROGMEM = "TEMP";
+const char humidLabel[] PROGMEM = "HUMID";
+const char moistLabel[] PROGMEM = "MOIST";
+
+StatWidget statWidgets[NUM_STATS] = {
+    {20, tempLabel, 35, "", BLACK, DIRTY_FRAME | DIRTY_VALUE, 0, 0},
+    {180, humidLabel, 25, "", BLACK, DIRTY_FRAME | DIRTY_VALUE, 0, 0},
+    {340, moistLabel, 25, "", BLACK, DIRTY_FRAME | DIRTY_VALUE, 0, 0}};
+
+// Render jobs: drawing is queued and done one slice at a time from loop(),
+// so Serial is drained between slices instead of after a whole screen.
+// A slice is one band of a fill (about SLICE_PIXELS), one word or one glyph,
+// which keeps the gap between RX polls at a few ms; at 115200 baud the
+// 63-byte RX buffer fills in ~5.5 ms.
+#define SLICE_PIXELS 2400
+#define JOB_QUEUE_SIZE 10
+
+#define JOB_FILL 0    // filled rect, a band of rows per slice
+#define JOB_OUTLINE 1 // rect outline
+#define JOB_FACE 2    // face text centered in the rect
+#define JOB_WRAP 3    // laid-out message, one word per slice
+#define JOB_STATS 4   // dirty stats widgets, one band or glyph per slice
+#define JOB_TILES 5   // dirty overview tiles, one band or text line per slice
+#define JOB_LABEL 6   // BigFont text on black
+#define JOB_HISTORY 7 // history strip, a few columns per slice
+
+// Job groups, so a newer draw can cancel the one it supersedes
+#define GROUP_SCREEN 0
+#define GROUP_MESSAGE 1
+
+struct RenderJob
+{
+  uint8_t kind;
+  uint8_t group;
+  int16_t x, y, w, h;
+  uint16_t color;
+  const char *text;
+  uint8_t index;   // progress: char offset in the line (JOB_WRAP), widget (JOB_STATS) or channel (JOB_TILES)
+  uint8_t phase;   // line (JOB_WRAP) or step (JOB_STATS, JOB_TILES)
+  int16_t cursorX;
+  int16_t cursorY;
+};
+
+RenderJob jobs[JOB_QUEUE_SIZE];
+uint8_t jobHead = 0;
+uint8_t jobCount = 0;
+
+// Stats value being drawn (the widget may change while it is in progress)
+char statDrawing[8];
+uint16_t statDrawingColor;
+
+// Voice text outlives the parser's line buffer while it is being drawn
+char voiceText[PARSER_MAX_VOICE + 1];
+
+// The mood face and message on screen, copied out of PROGMEM by show()
+#define MOOD_FACE_MAX 3
+#define MOOD_MESSAGE_MAX 47
+char moodFace[MOOD_FACE_MAX + 1];
+char moodMessage[MOOD_MESSAGE_MAX + 1];
+
+// SRAM budget. Of the Uno's 2048 bytes the stack peaks around 300 (a
+// 108-byte glyph row under loop()), Serial takes ~160 and the parser,
+// display object, widgets and small state ~370. The big buffers above get
+// 512 plus 200 for the render jobs, which leaves ~500 free; growing one
+// past that breaks the build instead of the heap.
+#define SRAM_TABLES_BUDGET 512
+#define SRAM_JOBS_BUDGET 200
+
+static_assert(sizeof(ChannelState) == 4, "ChannelState must stay packed to 4 bytes");
+static_assert(sizeof(channels) + sizeof(historySamples) + sizeof(labelText) + sizeof(statDrawing) +
+                      sizeof(voiceText) + sizeof(moodFace) + sizeof(moodMessage) <=
+                  SRAM_TABLES_BUDGET,
+              "channel table, history and text buffers are over their SRAM budget");
+#ifdef __AVR__
+static_assert(sizeof(jobs) <= SRAM_JOBS_BUDGET, "render job queue is over its SRAM budget"); // host pointers are wider
+#endif
+
+// Message text: built-in font at size 3, which is fixed width, so line
+// breaks are worked out once per message (lib/TextLayout) and cached
+#define WRAP_SIZE 3
+#define WRAP_CHAR_W (6 * WRAP_SIZE)
+#define WRAP_CHAR_H (8 * WRAP_SIZE)
+#define WRAP_MARGIN 12
+#define WRAP_GAP 6                    // between words
+#define WRAP_LINE_H (WRAP_CHAR_H + 6) // line pitch
+
+LayoutCache layouts;
+
+// Frame scheduling: commands only update state and the screen catches up at
+// most once per frame, so a burst like S T / S H / S M costs one redraw and
+// never shows the intermediate states
+#define FRAME_WINDOW_MS 30 // collect the rest of a burst for this long
+#define FRAME_MIN_MS 100   // max frame rate (10 fps)
+
+#define SCREEN_NONE 0
+#define SCREEN_HEALTHY 1
+#define SCREEN_UNHEALTHY 2
+
+bool frameDirty = false;
+unsigned long frameStart = 0; // first change waiting for a frame
+unsigned long lastFrame = 0;
+uint8_t pendingScreen = SCREEN_NONE;
+uint8_t shownScreen = SCREEN_NONE;
+bool pendingVoice = false;
+bool voiceSuperseded = false; // pendingVoice came before pendingScreen
+
+#ifdef LCD_PROFILE
+// Render profiling (build with the uno_profile env, query with "P").
+// Everything handleCommand() does is time spent away from draining Serial;
+// at 115200 baud ~11.5 bytes arrive per ms and the RX buffer holds 63.
+struct RenderProfile
+{
+  unsigned long commands; // lines handled since the last report
+  unsigned long totalUs;  // time spent in handleCommand()
+  unsigned long maxUs;    // worst single command
+  unsigned long slices;   // render slices run
+  unsigned long sliceMaxUs; // worst single slice
+  unsigned long frames;   // redraws scheduled
+  int rxPeak;             // highest Serial.available() seen
+  unsigned int rxFull;    // times the RX buffer was found full (bytes likely lost)
+  unsigned long offscreen; // readings for channels not on screen (table write only)
+};
+
+RenderProfile profile;
+
+void profileRx(int pending)
+{
+  if (pending > profile.rxPeak)
+  {
+    profile.rxPeak = pending;
+  }
+  if (pending >= SERIAL_RX_BUFFER_SIZE - 1)
+  {
+    profile.rxFull++;
+  }
+}
+
+void profileCommand(unsigned long us)
+{
+  profile.commands++;
+  profile.totalUs += us;
+  if (us > profile.maxUs)
+  {
+    profile.maxUs = us;
+  }
+}
+
+void profileSlice(unsigned long us)
+{
+  profile.slices++;
+  if (us > profile.sliceMaxUs)
+  {
+    profile.sliceMaxUs = us;
+  }
+}
+
+void printProfile()
+{
+  Serial.print(F("PROF cmds="));
+  Serial.print(profile.commands);
+  Serial.print(F(" avg_us="));
+  Serial.print(profile.commands ? profile.totalUs / profile.commands : 0);
+  Serial.print(F(" max_us="));
+  Serial.print(profile.maxUs);
+  Serial.print(F(" frames="));
+  Serial.print(profile.frames);
+  Serial.print(F(" slices="));
+  Serial.print(profile.slices);
+  Serial.print(F(" slice_max_us="));
+  Serial.print(profile.sliceMaxUs);
+  Serial.print(F(" rx_peak="));
+  Serial.print(profile.rxPeak);
+  Serial.print(F(" rx_full="));
+  Serial.print(profile.rxFull);
+  Serial.print(F(" offscreen="));
+  Serial.print(profile.offscreen);
+  Serial.print(F(" moist_flips="));
+  Serial.print(moisture.transitions());
+  Serial.print(F(" moist_suppressed="));
+  Serial.println(moisture.suppressed());
+
+  memset(&profile, 0, sizeof(profile));
+  moisture.resetCounters();
+}
+#endif
+
 void setup()
 {
   Serial.begin(115200); // Must match Python SerialBridge baudrate
@@ -271,120 +637,613 @@ void setup()
 
   tft.fillScreen(WHITE);
 
+  for (uint8_t i = 0; i < MAX_CHANNELS; i++)
+  {
+    channels[i].temp = NO_TEMP;
+    channels[i].humid = NO_HUMID;
+  }
+
   // Show initial display
   healthy();
+  shownScreen = SCREEN_HEALTHY;
+  updateStatValues();
   stats();
+  history();
 
-  Serial.println("LCD Ready");
+  // Nothing to drain yet, draw the first screen in one go
+  while (renderSlice())
+  {
+  }
+
+  Serial.println(F("LCD Ready"));
 }
 
 void loop()
 {
   // Read serial data
+#ifdef LCD_PROFILE
+  profileRx(Serial.available());
+#endif
   while (Serial.available())
   {
-    char c = Serial.read();
+    uint8_t c = Serial.read();
+    bool binary = binaryMode; // a command may switch modes
+    FrameStatus status = FRAME_PENDING;
 
-    if (c == '\n')
+    // Parsed as it arrives; handled once a complete line or frame is in
+    if (binary ? (status = frames.feed(c)) != FRAME_PENDING : parser.feed(c))
     {
-      // Process complete line
-      serialBuffer.trim();
-      if (serialBuffer.length() > 0)
+#ifdef LCD_PROFILE
+      unsigned long start = micros();
+#endif
+      if (binary)
+      {
+        handleFrame(status);
+      }
+      else
       {
-        handleCommand(serialBuffer);
+        handleCommand(parser);
       }
-      serialBuffer = "";
+#ifdef LCD_PROFILE
+      profileCommand(micros() - start);
+#endif
     }
-    else if (c != '\r')
-    {
-      serialBuffer += c;
+  }
+
+  // A history column for the shown plant every HISTORY_MS
+  unsigned long now = millis();
+  if (now - historyAt >= HISTORY_MS)
+  {
+    historyAt = now;
+    recordHistory();
+  }
 
-      // Prevent buffer overflow
-      if (serialBuffer.length() > 64)
+  // Overview: on to the next page with plants every PAGE_MS
+  if (viewMode == MODE_OVERVIEW && now - pageShownAt >= PAGE_MS)
+  {
+    pageShownAt = now;
+    for (uint8_t i = 1; i < PAGES; i++)
+    {
+      uint8_t next = (page + i) % PAGES;
+      if ((channelsSeen >> (next * TILES_PER_PAGE)) & ((1 << TILES_PER_PAGE) - 1))
       {
-        serialBuffer = "";
+        page = next;
+        viewChanged = true;
+        markFrame();
+        break;
       }
     }
   }
+
+  // Once a burst is over, apply it as a single frame
+  if (frameDirty && now - frameStart >= FRAME_WINDOW_MS && now - lastFrame >= FRAME_MIN_MS)
+  {
+    frame();
+  }
+
+  // Then one bounded piece of drawing before polling Serial again
+#ifdef LCD_PROFILE
+  unsigned long start = micros();
+  if (renderSlice())
+  {
+    profileSlice(micros() - start);
+  }
+#else
+  renderSlice();
+#endif
+
+  // Let a host that got BUSY resume sending
+  if (busySent && jobCount <= READY_DEPTH)
+  {
+    busySent = false;
+    Serial.print(F("RDY "));
+    Serial.println(jobCount);
+  }
+}
+
+// Check a sequence number before a command is applied. Returns false if the
+// command must be skipped; the reply has been sent already.
+bool acceptSeq(uint8_t seq)
+{
+  if (seqKnown && seq != expectedSeq)
+  {
+    uint8_t behind = expectedSeq - seq;
+    if (behind <= ACK_WINDOW)
+    {
+      // Retransmission of something already applied: repeat the ack
+      ack(expectedSeq - 1);
+    }
+    else
+    {
+      // Something before it was lost: go back to the expected one
+      nak(expectedSeq, F("SEQ"));
+    }
+    return false;
+  }
+
+  seqKnown = true;
+  expectedSeq = seq + 1;
+  return true;
+}
+
+// Cumulative ack for everything up to seq, with the render queue depth.
+// BUSY is still an ack, but asks the host to hold off until RDY.
+void ack(uint8_t seq)
+{
+  if (jobCount >= BUSY_DEPTH)
+  {
+    busySent = true;
+    Serial.print(F("BUSY "));
+  }
+  else
+  {
+    Serial.print(F("ACK "));
+  }
+  Serial.print(seq);
+  Serial.print(' ');
+  Serial.println(jobCount);
+}
+
+// SEQ and CRC: resend from seq. BAD: seq was consumed but rejected.
+void nak(uint8_t seq, const __FlashStringHelper *reason)
+{
+  Serial.print(F("NAK "));
+  Serial.print(seq);
+  Serial.print(' ');
+  Serial.println(reason);
+}
+
+// Reply to a text command: "OK <what>" when untagged, an ack when tagged
+void reply(const CommandParser &command, const __FlashStringHelper *ok)
+{
+  if (command.tagged())
+  {
+    ack(command.seq());
+  }
+  else
+  {
+    Serial.println(ok);
+  }
 }
 
 // Parse and handle serial command
-void handleCommand(const String &line)
+void handleCommand(const CommandParser &command)
 {
-  if (line.length() < 2)
+  CommandType type = command.type();
+  char field = command.field();
+
+  if (command.tagged() && !acceptSeq(command.seq()))
+  {
     return;
+  }
 
-  // Temperature: "S T 23"
-  if (line.startsWith("S T "))
+  // Channels past the end of the table
+  if ((type == CMD_STAT && command.channel() >= MAX_CHANNELS) ||
+      (type == CMD_CHANNEL && (command.value() < 0 || command.value() >= MAX_CHANNELS)))
   {
-    currentTemp = line.substring(4).toInt();
-    stats();
-    Serial.println("OK TEMP");
+    type = CMD_UNKNOWN;
+  }
+
+  // Temperature: "S T 23", or "S3 T 23" for channel 3
+  if (type == CMD_STAT && field == 'T')
+  {
+    updateChannel(command.channel(), SAMPLE_HAS_TEMP, command.value(), 0, 0);
+    reply(command, F("OK TEMP"));
   }
   // Humidity: "S H 65"
-  else if (line.startsWith("S H "))
+  else if (type == CMD_STAT && field == 'H')
   {
-    currentHumid = line.substring(4).toInt();
-    stats();
-    Serial.println("OK HUMID");
+    updateChannel(command.channel(), SAMPLE_HAS_HUMID, 0, command.value(), 0);
+    reply(command, F("OK HUMID"));
+  }
+  else if (type == CMD_STAT && field == 'M')
+  {
+    updateChannel(command.channel(), SAMPLE_HAS_MOIST, 0, 0, command.value());
+    reply(command, F("OK MOIST"));
+  }
+  // One plant: "C 3"
+  else if (type == CMD_CHANNEL)
+  {
+    showChannel(command.value());
+    reply(command, F("OK CHANNEL"));
   }
-  else if (line.startsWith("S M "))
+  // All plants: "O"
+  else if (type == CMD_OVERVIEW)
   {
-    currentMoist = line.substring(4).toInt();
+    showOverview();
+    reply(command, F("OK OVERVIEW"));
+  }
+  // Voice text: "V LIGHTS ON"
+  else if (type == CMD_VOICE)
+  {
+    voice(command.text());
+    reply(command, F("OK VOICE"));
+  }
 
-    // Determine mood from moisture category
-    bool newBad = (currentMoist < 1000); // BAD if under 1000, else happy for average+good
+  // Healthy state: "H"
+  else if (type == CMD_HEALTHY)
+  {
+    requestScreen(SCREEN_HEALTHY, true);
+    reply(command, F("OK HEALTHY"));
+  }
+  // Unhealthy state: "U"
+  else if (type == CMD_UNHEALTHY)
+  {
+    requestScreen(SCREEN_UNHEALTHY, true);
+    reply(command, F("OK UNHEALTHY"));
+  }
+  // Binary frames from here on: "B"
+  else if (type == CMD_BINARY)
+  {
+    binaryMode = true;
+    frames.reset();
+    seqKnown = command.tagged(); // untagged: frames start a new sequence
+    reply(command, F("OK BINARY"));
+  }
+  // The host restarted its sequence (it was reset, we were not): "R"
+  else if (type == CMD_RESYNC)
+  {
+    seqKnown = command.tagged();
+    reply(command, F("OK SEQ"));
+  }
+#ifdef LCD_PROFILE
+  // Profile report: "P"
+  else if (type == CMD_PROFILE)
+  {
+    printProfile();
+    if (command.tagged())
+    {
+      ack(command.seq());
+    }
+  }
+#endif
+  else if (command.tagged())
+  {
+    nak(command.seq(), F("BAD"));
+  }
+  else
+  {
+    Serial.print(F("ERR Unknown: "));
+    Serial.println(command.line());
+  }
+}
+// Handle a binary frame (see lib/BinaryFrame)
+void handleFrame(FrameStatus status)
+{
+  if (status == FRAME_BAD)
+  {
+    // The seq can't be trusted: ask for everything from the expected one
+    nak(expectedSeq, F("CRC"));
+    return;
+  }
+
+  uint8_t seq = frames.seq();
+  if (!acceptSeq(seq))
+  {
+    return;
+  }
 
-    // Only change the big face/message when category changes
-    if (newBad != moistureIsBad)
+  switch (frames.type())
+  {
+  case FRAME_SAMPLE:
+  {
+    SampleFrame sample;
+    if (!readSample(frames.payload(), frames.payloadLength(), sample) || sample.channel >= MAX_CHANNELS)
     {
-      moistureIsBad = newBad;
+      nak(seq, F("BAD"));
+      return;
+    }
 
-      if (moistureIsBad)
-      {
-        unhealthy(); // sad faces + sad messages
-      }
-      else
-      {
-        healthy(); // happy faces + happy messages
-      }
+    // One frame carries the whole sample, so it costs a single redraw
+    updateChannel(sample.channel, sample.fields, sample.tempTenths / 10, sample.humidity, sample.moisture);
+    break;
+  }
+
+  case FRAME_VIEW:
+  {
+    uint8_t view = frames.payloadLength() ? frames.payload()[0] : VIEW_OVERVIEW;
+    if (view == VIEW_OVERVIEW)
+    {
+      showOverview();
+    }
+    else if (view < MAX_CHANNELS)
+    {
+      showChannel(view);
+    }
+    else
+    {
+      nak(seq, F("BAD"));
+      return;
     }
+    break;
+  }
 
-    // Always update the stats boxes
-    stats();
-    Serial.println("OK MOIST");
+  case FRAME_MOOD:
+    requestScreen(frames.payloadLength() && frames.payload()[0] ? SCREEN_UNHEALTHY : SCREEN_HEALTHY, true);
+    break;
+
+  case FRAME_VOICE:
+  {
+    char text[PARSER_MAX_VOICE + 1];
+    uint8_t length = min(frames.payloadLength(), PARSER_MAX_VOICE);
+
+    memcpy(text, frames.payload(), length);
+    text[length] = '\0';
+    voice(text);
+    break;
   }
 
-  // Healthy state: "H"
-  else if (line.equals("H"))
+  case FRAME_TEXT:
+    binaryMode = false;
+    parser.reset();
+    break;
+
+  default:
+    nak(seq, F("BAD"));
+    return;
+  }
+  ack(seq);
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+bool onScreen(uint8_t ch)
+{
+  return viewMode == MODE_DETAIL ? ch == shownChannel : ch / TILES_PER_PAGE == page;
+}
+
+// Store a reading (SAMPLE_HAS_* fields) in the channel table. Only a channel
+// that is on screen schedules a frame; any other costs just the table write.
+void updateChannel(uint8_t ch, uint8_t fields, int temp, int humid, int moist)
+{
+  ChannelState &state = channels[ch];
+  bool seen = channelsSeen & (1U << ch);
+  uint8_t dirty = seen ? DIRTY_VALUE : DIRTY_FRAME | DIRTY_VALUE;
+
+  if (fields & SAMPLE_HAS_TEMP)
+  {
+    state.temp = constrain(temp, -127, 127);
+  }
+  if (fields & SAMPLE_HAS_HUMID)
+  {
+    state.humid = constrain(humid, 0, 100);
+  }
+  if (fields & SAMPLE_HAS_MOIST)
+  {
+    moist = constrain(moist, 0, MOIST_MAX);
+
+    // The shown plant gets the filtered level that drives the mood; the
+    // others only hysteresis, which needs no state besides the level
+    MoistureLevel level;
+    if (ch == shownChannel)
+    {
+      moisture.update(moist, millis());
+      level = moisture.level();
+    }
+    else
+    {
+      level = state.hasMoist ? moisture.band((MoistureLevel)state.level, moist) : moisture.levelOf(moist);
+    }
+
+    if (!state.hasMoist || level != state.level)
+    {
+      dirty |= DIRTY_FRAME; // the tile color follows the level
+    }
+    state.moist = moist;
+    state.level = level;
+    state.hasMoist = 1;
+  }
+
+  state.dirty |= dirty;
+  channelsSeen |= 1U << ch;
+
+  if (!onScreen(ch))
+  {
+#ifdef LCD_PROFILE
+    profile.offscreen++;
+#endif
+#if AUTO_OVERVIEW
+    if (viewMode == MODE_DETAIL && !viewChosen)
+    {
+      viewMode = MODE_OVERVIEW;
+      page = shownChannel / TILES_PER_PAGE;
+      viewChanged = true;
+      markFrame();
+    }
+#endif
+    return;
+  }
+
+  bool newBad = (moisture.level() == MOIST_BAD); // happy for average+good, and before any reading
+
+  // Only change the big face/message when category changes
+  if (viewMode == MODE_DETAIL && (fields & SAMPLE_HAS_MOIST) && newBad != moistureIsBad)
+  {
+    moistureIsBad = newBad;
+
+    // sad faces + sad messages, or happy faces + happy messages
+    requestScreen(moistureIsBad ? SCREEN_UNHEALTHY : SCREEN_HEALTHY, false);
+  }
+
+  // Always update the stats boxes or tiles (repaints only what changed)
+  markFrame();
+}
+
+// Detail view of one channel, from the next frame
+void showChannel(uint8_t ch)
+{
+  if (ch != shownChannel)
+  {
+    // The classifier follows the shown plant, starting from its last reading
+    shownChannel = ch;
+    moisture = MoistureClassifier(moistureConfig);
+    if (channels[ch].hasMoist)
+    {
+      moisture.update(channels[ch].moist, millis());
+    }
+
+    // and so does the history, from scratch
+    memset(historySamples, 0, sizeof(historySamples));
+    historyHead = 0;
+    historyDrawn = 0;
+    historyInvalid = true;
+  }
+
+  viewChosen = true;
+  viewMode = MODE_DETAIL;
+  viewChanged = true;
+  markFrame();
+}
+
+// Overview from the page of the shown channel, from the next frame
+void showOverview()
+{
+  viewChosen = true;
+  viewMode = MODE_OVERVIEW;
+  page = shownChannel / TILES_PER_PAGE;
+  viewChanged = true;
+  markFrame();
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+// Note that the screen needs to catch up with the current state
+void markFrame()
+{
+  if (!frameDirty)
+  {
+    frameDirty = true;
+    frameStart = millis();
+  }
+}
+
+// Ask for a mood screen on the next frame. A mood flip that flips back
+// before the frame is drawn cancels itself; H/U always repaint.
+void requestScreen(uint8_t screen, bool force)
+{
+  pendingScreen = (force || screen != shownScreen) ? screen : SCREEN_NONE;
+
+  // A new screen brings its own message; a cancelled flip leaves any
+  // voice text waiting to be drawn
+  voiceSuperseded = pendingVoice && pendingScreen != SCREEN_NONE;
+  markFrame();
+}
+
+// Apply everything that changed since the last frame as one redraw
+void frame()
+{
+  if (viewChanged && viewMode == MODE_DETAIL)
+  {
+    // Back to one plant: its mood screen, whatever was shown before
+    moistureIsBad = (moisture.level() == MOIST_BAD);
+    pendingScreen = moistureIsBad ? SCREEN_UNHEALTHY : SCREEN_HEALTHY;
+  }
+  else if (viewChanged)
+  {
+    overview();
+  }
+  viewChanged = false;
+
+  if (viewMode == MODE_OVERVIEW)
+  {
+    // No mood screen or message over the tiles
+    pendingScreen = SCREEN_NONE;
+    pendingVoice = false;
+    tiles();
+  }
+
+  if (pendingScreen == SCREEN_HEALTHY)
   {
     healthy();
-    stats();
-    Serial.println("OK HEALTHY");
   }
-  // Unhealthy state: "U"
-  else if (line.equals("U"))
+  else if (pendingScreen == SCREEN_UNHEALTHY)
   {
     unhealthy();
+  }
+  if (pendingScreen != SCREEN_NONE)
+  {
+    shownScreen = pendingScreen;
+    pendingScreen = SCREEN_NONE;
+  }
+
+  if (pendingVoice && !voiceSuperseded)
+  {
+    messageBox(voiceText);
+  }
+  pendingVoice = false;
+  voiceSuperseded = false;
+
+  if (viewMode == MODE_DETAIL)
+  {
+    updateStatValues();
     stats();
-    Serial.println("OK UNHEALTHY");
+    history();
   }
-  else
+
+  frameDirty = false;
+  lastFrame = millis();
+#ifdef LCD_PROFILE
+  profile.frames++;
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+// Queue a job; returns NULL when the queue is full and the draw is dropped
+RenderJob *queueJob(uint8_t kind, uint8_t group, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  if (jobCount >= JOB_QUEUE_SIZE)
   {
-    Serial.print("ERR Unknown: ");
-    Serial.println(line);
+    return NULL;
   }
+
+  RenderJob &job = jobs[(jobHead + jobCount) % JOB_QUEUE_SIZE];
+  jobCount++;
+
+  memset(&job, 0, sizeof(job));
+  job.kind = kind;
+  job.group = group;
+  job.x = x;
+  job.y = y;
+  job.w = w;
+  job.h = h;
+  job.color = color;
+  return &job;
 }
+
+// Drop queued (and in-progress) jobs of a group
+void cancelJobs(uint8_t group)
+{
+  uint8_t kept = 0;
+
+  for (uint8_t i = 0; i < jobCount; i++)
+  {
+    RenderJob &job = jobs[(jobHead + i) % JOB_QUEUE_SIZE];
+    if (job.group != group)
+    {
+      jobs[(jobHead + kept) % JOB_QUEUE_SIZE] = job;
+      kept++;
+    }
+  }
+  jobCount = kept;
+}
+
 //--------------------------------------------------------------------------------------------------------------------
-void show(uint16_t bgColor, const char *faces[], const char *messages[], int numItems)
+void show(uint16_t bgColor, const char *const faces[], const char *const messages[], int numItems)
 {
 
-  tft.fillScreen(bgColor);
+  // A new mood screen supersedes anything still being drawn
+  jobCount = 0;
+
+  queueJob(JOB_FILL, GROUP_SCREEN, 0, 0, tft.width(), tft.height(), bgColor);
+  invalidateStats(); // the fill wipes the stats strip
+  historyInvalid = true; // and the history
 
   int randomIndex = random(numItems);
 
-  const char *face = faces[randomIndex];
-  const char *message = messages[randomIndex];
+  // Only the one shown needs SRAM; nothing still queued points at these
+  strncpy_P(moodFace, (PGM_P)pgm_read_ptr(&faces[randomIndex]), MOOD_FACE_MAX);
+  moodFace[MOOD_FACE_MAX] = '\0';
+  strncpy_P(moodMessage, (PGM_P)pgm_read_ptr(&messages[randomIndex]), MOOD_MESSAGE_MAX);
+  moodMessage[MOOD_MESSAGE_MAX] = '\0';
+  layouts.forget(moodMessage); // same buffer, new text
 
   // -------- FACE BOX --------
   int faceBoxWidth = 100;
@@ -392,226 +1251,751 @@ void show(uint16_t bgColor, const char *faces[], const char *messages[], int num
   int faceBoxX = 30;
   int faceBoxY = 120;
 
-  tft.fillRect(faceBoxX, faceBoxY, faceBoxWidth, faceBoxHeight, BLACK);
+  queueJob(JOB_FILL, GROUP_SCREEN, faceBoxX, faceBoxY, faceBoxWidth, faceBoxHeight, BLACK);
+
+  RenderJob *job = queueJob(JOB_FACE, GROUP_SCREEN, faceBoxX, faceBoxY, faceBoxWidth, faceBoxHeight, WHITE);
+  if (job)
+  {
+    job->text = moodFace;
+  }
+  channelLabel();
+
+  messageBox(moodMessage);
+}
+
+// Clear the screen for the current page and queue all of its tiles
+void overview()
+{
+  jobCount = 0; // supersedes anything still being drawn
+  queueJob(JOB_FILL, GROUP_SCREEN, 0, 0, tft.width(), tft.height(), BLACK);
+
+  for (uint8_t i = 0; i < TILES_PER_PAGE; i++)
+  {
+    channels[page * TILES_PER_PAGE + i].dirty = DIRTY_FRAME | DIRTY_VALUE;
+  }
+
+  shownScreen = SCREEN_NONE;
+  pageShownAt = millis();
+}
+
+// Channel number at the bottom of the face box, once there are other plants
+void channelLabel()
+{
+  if ((channelsSeen | (1U << shownChannel)) == 1)
+  {
+    return; // only ever channel 0
+  }
+
+  snprintf(labelText, sizeof(labelText), "#%d", shownChannel);
+  int16_t w = strlen(labelText) * BIGFONT_CELL_W * TILE_LABEL_SIZE;
+
+  RenderJob *job = queueJob(JOB_LABEL, GROUP_SCREEN, 30 + (100 - w) / 2, 200, w, 8 * TILE_LABEL_SIZE, WHITE);
+  if (job)
+  {
+    job->text = labelText;
+  }
+}
 
+void faceSlice(RenderJob &job)
+{
   tft.setTextSize(4);
-  tft.setTextColor(WHITE);
+  tft.setTextColor(job.color);
 
   int16_t x1, y1;
   uint16_t w, h;
 
-  tft.getTextBounds(face, 0, 0, &x1, &y1, &w, &h);
+  tft.getTextBounds(job.text, 0, 0, &x1, &y1, &w, &h);
 
-  int textX = faceBoxX + (faceBoxWidth - w) / 2;
-  int textY = faceBoxY + (faceBoxHeight - h) / 2;
+  int textX = job.x + (job.w - w) / 2;
+  int textY = job.y + (job.h - h) / 2;
 
   tft.setCursor(textX, textY);
-  tft.print(face);
+  tft.print(job.text);
+}
 
-  // -------- MESSAGE BOX --------
+// -------- MESSAGE BOX --------
+void messageBox(const char *message)
+{
   int msgBoxWidth = 300;
   int msgBoxHeight = 150;
   int msgBoxX = 160;
   int msgBoxY = 120;
 
-  tft.fillRect(msgBoxX, msgBoxY, msgBoxWidth, msgBoxHeight, WHITE);
-  tft.drawRect(msgBoxX, msgBoxY, msgBoxWidth, msgBoxHeight, BLACK);
+  cancelJobs(GROUP_MESSAGE);
+
+  queueJob(JOB_FILL, GROUP_MESSAGE, msgBoxX, msgBoxY, msgBoxWidth, msgBoxHeight, WHITE);
+  queueJob(JOB_OUTLINE, GROUP_MESSAGE, msgBoxX, msgBoxY, msgBoxWidth, msgBoxHeight, BLACK);
 
-  printWrappedText(message, msgBoxX, msgBoxY, msgBoxWidth, msgBoxHeight);
+  RenderJob *job = queueJob(JOB_WRAP, GROUP_MESSAGE, msgBoxX, msgBoxY, msgBoxWidth, msgBoxHeight, BLACK);
+  if (job)
+  {
+    job->text = message;
+  }
 }
 
-void healthy()
+// Voice text replaces the mood message until the next mood change
+void voice(const char *text)
 {
+  cancelJobs(GROUP_MESSAGE); // may still be drawing the previous voiceText
+
+  strncpy(voiceText, text, PARSER_MAX_VOICE);
+  voiceText[PARSER_MAX_VOICE] = '\0';
+  layouts.forget(voiceText); // same buffer, new text
+  pendingVoice = true;
+  voiceSuperseded = false;
+  markFrame();
+}
 
-  const char *faces[] = {
-      "n_n",
-      "^_^",
-      "o_o",
-      ">_<"};
-
-  const char *messages[] = {
-      "Hydrated and glowing, just like you!",
-      "Sending you both lots of love <3",
-      "Small steps still count!",
-      "Thinking of you..."};
+// Mood faces and messages live in flash; show() copies out the one it picks
+const char healthyFace0[] PROGMEM = "n_n";
+const char healthyFace1[] PROGMEM = "^_^";
+const char healthyFace2[] PROGMEM = "o_o";
+const char healthyFace3[] PROGMEM = ">_<";
+const char *const healthyFaces[] PROGMEM = {healthyFace0, healthyFace1, healthyFace2, healthyFace3};
+
+const char healthyMessage0[] PROGMEM = "Hydrated and glowing, just like you!";
+const char healthyMessage1[] PROGMEM = "Sending you both lots of love <3";
+const char healthyMessage2[] PROGMEM = "Small steps still count!";
+const char healthyMessage3[] PROGMEM = "Thinking of you...";
+const char *const healthyMessages[] PROGMEM = {healthyMessage0, healthyMessage1, healthyMessage2, healthyMessage3};
+
+const char unhealthyFace0[] PROGMEM = "T_T";
+const char unhealthyFace1[] PROGMEM = ";_;";
+const char unhealthyFace2[] PROGMEM = "x_x";
+const char unhealthyFace3[] PROGMEM = ">_<";
+const char *const unhealthyFaces[] PROGMEM = {unhealthyFace0, unhealthyFace1, unhealthyFace2, unhealthyFace3};
+
+const char unhealthyMessage0[] PROGMEM = "Feeling a little dry... still love you though.";
+const char unhealthyMessage1[] PROGMEM = "A bit thirsty, but I know you care.";
+const char unhealthyMessage2[] PROGMEM = "Low energy today... send water please.";
+const char unhealthyMessage3[] PROGMEM = "Missing some sunshine and love.";
+const char *const unhealthyMessages[] PROGMEM = {unhealthyMessage0, unhealthyMessage1, unhealthyMessage2,
+                                                 unhealthyMessage3};
 
-  show(GREEN, faces, messages, 4);
+void healthy()
+{
+  show(GREEN, healthyFaces, healthyMessages, 4);
 }
 
 //--------------------------------------------------------------------------------------------------------------------
 void unhealthy()
 {
+  show(RED, unhealthyFaces, unhealthyMessages, 4);
+}
 
-  const char *faces[] = {
-      "T_T",
-      ";_;",
-      "x_x",
-      ">_<"};
+PGM_P moistureLabel(MoistureLevel level)
+{
+  if (level == MOIST_UNKNOWN)
+  {
+    return PSTR("--");
+  }
+  else if (level == MOIST_GOOD)
+  {
+    return PSTR("GOOD");
+  }
+  else if (level == MOIST_AVERAGE)
+  {
+    return PSTR("AVERAGE");
+  }
+  else
+  {
+    return PSTR("BAD");
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+// Set the text/color a stats widget should show; marks it dirty only on change
+void setStat(int index, const char *text, uint16_t color)
+{
+  StatWidget &widget = statWidgets[index];
 
-  const char *messages[] = {
-      "Feeling a little dry... still love you though.",
-      "A bit thirsty, but I know you care.",
-      "Low energy today... send water please.",
-      "Missing some sunshine and love."};
+  if (strcmp(widget.value, text) == 0 && widget.color == color)
+  {
+    return;
+  }
 
-  show(RED, faces, messages, 4);
+  strncpy(widget.value, text, sizeof(widget.value) - 1);
+  widget.value[sizeof(widget.value) - 1] = '\0';
+  widget.color = color;
+  widget.dirty |= DIRTY_VALUE;
 }
 
-const char *moistureLabel(int value)
+void updateStatValues()
 {
-  if (value > 2000)
+  const ChannelState &state = channels[shownChannel];
+  char buffer[8];
+
+  if (state.temp == NO_TEMP)
   {
-    return "GOOD";
+    sprintf_P(buffer, PSTR("--%cC"), 247);
   }
-  else if (value >= 1000)
+  else
+  {
+    sprintf_P(buffer, PSTR("%d%cC"), state.temp, 247);
+  }
+  setStat(STAT_TEMP, buffer, BLACK);
+
+  if (state.humid == NO_HUMID)
   {
-    return "AVERAGE";
+    strcpy_P(buffer, PSTR("--%"));
   }
   else
   {
-    return "BAD";
+    sprintf_P(buffer, PSTR("%d%%"), state.humid);
   }
+  setStat(STAT_HUMID, buffer, BLACK);
+
+  uint16_t moistColor;
+  if (moisture.level() == MOIST_UNKNOWN)
+  {
+    moistColor = BLACK;
+  }
+  else if (moisture.level() == MOIST_GOOD)
+  {
+    moistColor = GREEN;
+  }
+  else if (moisture.level() == MOIST_AVERAGE)
+  {
+    moistColor = YELLOW;
+  }
+  else
+  {
+    moistColor = RED;
+  }
+  strcpy_P(buffer, moistureLabel(moisture.level()));
+  setStat(STAT_MOIST, buffer, moistColor);
 }
 
-//--------------------------------------------------------------------------------------------------------------------
+// Force a full repaint of every widget (e.g. after the screen was cleared)
+void invalidateStats()
+{
+  for (int i = 0; i < NUM_STATS; i++)
+  {
+    statWidgets[i].dirty = DIRTY_FRAME | DIRTY_VALUE;
+    statWidgets[i].drawnW = 0;
+  }
+}
+
+// Schedule a repaint of the dirty parts of the stats strip
 void stats()
 {
+  // A queued stats job rescans the widgets, so one is enough
+  for (uint8_t i = 0; i < jobCount; i++)
+  {
+    if (jobs[(jobHead + i) % JOB_QUEUE_SIZE].kind == JOB_STATS)
+    {
+      return;
+    }
+  }
 
-  // 3 equal boxes at top: 480px width / 3 = 160px each, with margins
-  int boxWidth = 140;
-  int boxHeight = 70;
-  int boxY = 20;
-  int spacing = 20;
-  int startX = 20;
+  queueJob(JOB_STATS, GROUP_SCREEN, 0, 0, 0, 0, 0);
+}
 
-  int16_t x1, y1;
-  uint16_t w, h;
+// Stats job steps
+#define STATS_NEXT 0        // pick the next dirty widget
+#define STATS_FILL 1        // box background, a band of rows per slice
+#define STATS_LABEL 2       // outline and label
+#define STATS_VALUE_START 3 // snapshot the value
+#define STATS_VALUE 4       // one glyph per slice
+#define STATS_CLEAR 5       // clear what is left of the old value
 
-  // ---------- TEMPERATURE BOX ----------
-  int tempBoxX = startX;
-  tft.fillRect(tempBoxX, boxY, boxWidth, boxHeight, WHITE);
-  tft.drawRect(tempBoxX, boxY, boxWidth, boxHeight, BLACK);
+bool statsSlice(RenderJob &job)
+{
+  StatWidget &widget = statWidgets[job.index];
+
+  switch (job.phase)
+  {
+  case STATS_NEXT:
+    for (uint8_t i = 0; i < NUM_STATS; i++)
+    {
+      if (statWidgets[i].dirty)
+      {
+        job.index = i;
+        job.cursorY = 0;
+        job.phase = (statWidgets[i].dirty & DIRTY_FRAME) ? STATS_FILL : STATS_VALUE_START;
+        return false;
+      }
+    }
+    return true; // all clean
 
-  tft.setTextSize(2);
-  tft.setTextColor(BLACK);
-  tft.setCursor(tempBoxX + 35, boxY + 8);
-  tft.print("TEMP");
+  case STATS_FILL:
+  {
+    int16_t rows = min(SLICE_PIXELS / STAT_BOX_W, STAT_BOX_H - job.cursorY);
+    tft.fillRect(widget.x, STAT_BOX_Y + job.cursorY, STAT_BOX_W, rows, WHITE);
+    job.cursorY += rows;
+    if (job.cursorY >= STAT_BOX_H)
+    {
+      job.phase = STATS_LABEL;
+    }
+    return false;
+  }
 
-  char tempBuffer[20];
-  sprintf(tempBuffer, "%d%cC", currentTemp, 247);
-  tft.setTextSize(3);
-  tft.getTextBounds(tempBuffer, 0, 0, &x1, &y1, &w, &h);
-  tft.setCursor(tempBoxX + (boxWidth - w) / 2, boxY + 35);
-  tft.print(tempBuffer);
+  case STATS_LABEL:
+    tft.drawRect(widget.x, STAT_BOX_Y, STAT_BOX_W, STAT_BOX_H, BLACK);
 
-  // ---------- HUMIDITY BOX ----------
-  int humidBoxX = startX + boxWidth + spacing;
-  tft.fillRect(humidBoxX, boxY, boxWidth, boxHeight, WHITE);
-  tft.drawRect(humidBoxX, boxY, boxWidth, boxHeight, BLACK);
+    for (uint8_t i = 0; pgm_read_byte(&widget.label[i]); i++)
+    {
+      blitGlyph(widget.x + widget.labelX + i * BIGFONT_CELL_W * STAT_LABEL_SIZE, STAT_LABEL_Y,
+                pgm_read_byte(&widget.label[i]), STAT_LABEL_SIZE, BLACK, WHITE);
+    }
 
-  tft.setTextSize(2);
-  tft.setCursor(humidBoxX + 25, boxY + 8);
-  tft.print("HUMID");
+    widget.drawnW = 0; // the fill wiped the old value
+    job.phase = STATS_VALUE_START;
+    return false;
 
-  char humidBuffer[20];
-  sprintf(humidBuffer, "%d%%", currentHumid);
-  tft.setTextSize(3);
-  tft.getTextBounds(humidBuffer, 0, 0, &x1, &y1, &w, &h);
-  tft.setCursor(humidBoxX + (boxWidth - w) / 2, boxY + 35);
-  tft.print(humidBuffer);
+  case STATS_VALUE_START:
+    memcpy(statDrawing, widget.value, sizeof(statDrawing));
+    statDrawingColor = widget.color;
+    widget.dirty = 0; // changes from here on need another pass
 
-  // ---------- MOISTURE BOX ----------
-  int moistBoxX = startX + 2 * (boxWidth + spacing);
-  tft.fillRect(moistBoxX, boxY, boxWidth, boxHeight, WHITE);
-  tft.drawRect(moistBoxX, boxY, boxWidth, boxHeight, BLACK);
+    job.cursorX = widget.x + (STAT_BOX_W - (int16_t)strlen(statDrawing) * STAT_CHAR_W) / 2;
+    job.cursorY = 0;
+    job.phase = statDrawing[0] ? STATS_VALUE : STATS_CLEAR;
+    return false;
 
-  tft.setTextSize(2);
-  tft.setCursor(moistBoxX + 25, boxY + 8);
-  tft.print("MOIST");
+  case STATS_VALUE:
+    // Opaque glyph cells overwrite the old value in place, no clear-then-draw
+    for (uint8_t n = 0; n < STAT_GLYPHS_PER_SLICE && statDrawing[job.cursorY]; n++)
+    {
+      blitGlyph(job.cursorX + job.cursorY * STAT_CHAR_W, STAT_VALUE_Y,
+                statDrawing[job.cursorY], STAT_VALUE_SIZE, statDrawingColor, WHITE);
+      job.cursorY++;
+    }
 
-  const char *label = moistureLabel(currentMoist);
+    if (statDrawing[job.cursorY] == '\0')
+    {
+      job.phase = STATS_CLEAR;
+    }
+    return false;
 
-  tft.setTextSize(3);
-  tft.getTextBounds(label, 0, 0, &x1, &y1, &w, &h);
-  tft.setCursor(moistBoxX + (boxWidth - w) / 2, boxY + 35);
-  if (currentMoist > 2000)
+  default: // STATS_CLEAR
   {
-    tft.setTextColor(GREEN);
+    int16_t x = job.cursorX;
+    int16_t w = job.cursorY * STAT_CHAR_W;
+
+    // Clear only the parts of the old value the new one did not cover
+    if (widget.drawnW > 0)
+    {
+      int16_t oldEnd = widget.drawnX + widget.drawnW;
+      int16_t newEnd = x + w;
+
+      if (widget.drawnX < x)
+      {
+        tft.fillRect(widget.drawnX, STAT_VALUE_Y, x - widget.drawnX, STAT_VALUE_H, WHITE);
+      }
+      if (oldEnd > newEnd)
+      {
+        tft.fillRect(newEnd, STAT_VALUE_Y, oldEnd - newEnd, STAT_VALUE_H, WHITE);
+      }
+    }
+
+    widget.drawnX = x;
+    widget.drawnW = w;
+    job.phase = STATS_NEXT;
+    return false;
   }
-  else if (currentMoist >= 1000)
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+// Schedule a repaint of the dirty tiles of the overview page
+void tiles()
+{
+  // A queued tiles job rescans the page, so one is enough
+  for (uint8_t i = 0; i < jobCount; i++)
   {
-    tft.setTextColor(YELLOW);
+    if (jobs[(jobHead + i) % JOB_QUEUE_SIZE].kind == JOB_TILES)
+    {
+      return;
+    }
+  }
+
+  queueJob(JOB_TILES, GROUP_SCREEN, 0, 0, 0, 0, 0);
+}
+
+uint16_t tileColor(const ChannelState &state)
+{
+  if (!state.hasMoist)
+  {
+    return WHITE;
+  }
+  else if (state.level == MOIST_GOOD)
+  {
+    return GREEN;
+  }
+  else if (state.level == MOIST_AVERAGE)
+  {
+    return YELLOW;
   }
   else
   {
-    tft.setTextColor(RED);
+    return RED;
   }
+}
 
-  tft.print(label);
-  tft.setTextColor(BLACK);
+// Tiles job steps
+#define TILES_NEXT 0 // pick the next dirty tile on the page
+#define TILES_FILL 1 // background, a band of rows per slice
+#define TILES_TEXT 2 // one line (cursorX) per slice, padded to overwrite the old one
+
+bool tilesSlice(RenderJob &job)
+{
+  uint8_t slot = job.index % TILES_PER_PAGE;
+  int16_t x = (slot % TILE_COLS) * TILE_W;
+  int16_t y = (slot / TILE_COLS) * TILE_H;
+  const ChannelState &state = channels[job.index];
+
+  switch (job.phase)
+  {
+  case TILES_NEXT:
+    for (uint8_t i = 0; i < TILES_PER_PAGE; i++)
+    {
+      uint8_t ch = page * TILES_PER_PAGE + i;
+      if (channels[ch].dirty && (channelsSeen & (1U << ch)))
+      {
+        // The color is kept for the whole tile; a level change while it
+        // is drawn marks it dirty again
+        job.index = ch;
+        job.color = tileColor(channels[ch]);
+        job.cursorY = 0;
+        job.phase = (channels[ch].dirty & DIRTY_FRAME) ? TILES_FILL : TILES_TEXT;
+        job.cursorX = (channels[ch].dirty & DIRTY_FRAME) ? 0 : 1; // label only with the frame
+        channels[ch].dirty = 0;
+        return false;
+      }
+    }
+    return true; // all clean
+
+  case TILES_FILL:
+  {
+    int16_t rows = min(SLICE_PIXELS / TILE_W, TILE_H - job.cursorY);
+    tft.fillRect(x, y + job.cursorY, TILE_W, rows, job.color);
+    job.cursorY += rows;
+    if (job.cursorY >= TILE_H)
+    {
+      tft.drawRect(x, y, TILE_W, TILE_H, BLACK);
+      job.phase = TILES_TEXT;
+    }
+    return false;
+  }
+
+  default: // TILES_TEXT
+  {
+    char line[8];
+    uint8_t size = TILE_TEXT_SIZE;
+    int16_t lineX = x + TILE_TEXT_X;
+    int16_t lineY = y + TILE_LINE_Y + (job.cursorX - 1) * TILE_LINE_H;
+
+    if (job.cursorX == 0)
+    {
+      sprintf_P(line, PSTR("#%d"), job.index);
+      size = TILE_LABEL_SIZE;
+      lineX = x + (TILE_W - (int16_t)strlen(line) * BIGFONT_CELL_W * size) / 2;
+      lineY = y + TILE_LABEL_Y;
+    }
+    else if (job.cursorX == 1 && state.temp != NO_TEMP)
+    {
+      sprintf_P(line, PSTR("%3d%cC"), state.temp, 247);
+    }
+    else if (job.cursorX == 1)
+    {
+      sprintf_P(line, PSTR(" --%cC"), 247);
+    }
+    else if (job.cursorX == 2 && state.humid != NO_HUMID)
+    {
+      sprintf_P(line, PSTR("%3d%% "), state.humid);
+    }
+    else if (job.cursorX == 2)
+    {
+      strcpy_P(line, PSTR(" --% "));
+    }
+    else if (state.hasMoist)
+    {
+      sprintf_P(line, PSTR("%4d "), state.moist);
+    }
+    else
+    {
+      strcpy_P(line, PSTR("  -- "));
+    }
+
+    for (uint8_t i = 0; line[i]; i++)
+    {
+      blitGlyph(lineX + i * BIGFONT_CELL_W * size, lineY, line[i], size, BLACK, job.color);
+    }
+
+    job.cursorX++;
+    if (job.cursorX >= TILE_LINES)
+    {
+      job.phase = TILES_NEXT;
+    }
+    return false;
+  }
+  }
 }
 
 //--------------------------------------------------------------------------------------------------------------------
-void printWrappedText(const char *text, int boxX, int boxY, int boxW, int boxH)
+// Add the shown plant's latest readings to the history
+void recordHistory()
 {
+  const ChannelState &state = channels[shownChannel];
+  int16_t values[NUM_METRICS] = {state.temp, state.humid, (int16_t)state.moist};
+  bool present[NUM_METRICS] = {state.temp != NO_TEMP, state.humid != NO_HUMID, (bool)state.hasMoist};
 
-  tft.setTextSize(3.5);
-  tft.setTextColor(BLACK);
+  for (uint8_t m = 0; m < NUM_METRICS; m++)
+  {
+    const HistoryMetric &metric = historyMetrics[m];
+    int16_t value = constrain(values[m], metric.low, metric.high);
 
-  int margin = 12;
-  int cursorX = boxX + margin;
-  int cursorY = boxY + margin;
+    historySamples[m][historyHead] =
+        present[m] ? 1 + (int32_t)(value - metric.low) * 254 / (metric.high - metric.low) : 0;
+  }
+  historyHead = (historyHead + 1) % HISTORY_LEN;
 
-  int maxX = boxX + boxW - margin;
-  int maxY = boxY + boxH - margin;
+  if (viewMode == MODE_DETAIL)
+  {
+    markFrame();
+  }
+}
 
-  char word[40]; // holds one word at a time
-  int wordIndex = 0;
+// Schedule drawing the history columns that are not on screen yet
+void history()
+{
+  // A queued history job catches up with every new column, so one is enough
+  for (uint8_t i = 0; i < jobCount; i++)
+  {
+    if (jobs[(jobHead + i) % JOB_QUEUE_SIZE].kind == JOB_HISTORY)
+    {
+      return;
+    }
+  }
 
-  for (int i = 0;; i++)
+  if (historyInvalid || historyDrawn != historyHead)
   {
+    queueJob(JOB_HISTORY, GROUP_SCREEN, 0, 0, 0, 0, 0);
+  }
+}
 
-    char c = text[i];
+int16_t historyY(uint8_t sample)
+{
+  return HISTORY_Y + HISTORY_H - 2 - (int16_t)(sample - 1) * (HISTORY_H - 2) / 254;
+}
 
-    if (c == ' ' || c == '\0')
+// One column: background, then a segment per metric from the previous
+// column's value to this one's. The cursor slot stays blank.
+void historyColumn(uint8_t slot)
+{
+  int16_t x = HISTORY_X + slot * HISTORY_COL_W;
+  tft.fillRect(x, HISTORY_Y, HISTORY_COL_W, HISTORY_H, HISTORY_BG);
+  if (slot == historyHead)
+  {
+    return;
+  }
+
+  // The oldest column (after the cursor) and column 0 start a new line
+  bool joined = slot > 0 && slot - 1 != historyHead;
+
+  for (uint8_t m = 0; m < NUM_METRICS; m++)
+  {
+    uint8_t sample = historySamples[m][slot];
+    if (sample == 0)
     {
+      continue;
+    }
 
-      word[wordIndex] = '\0'; // end word
+    int16_t y = historyY(sample);
+    int16_t from = (joined && historySamples[m][slot - 1]) ? historyY(historySamples[m][slot - 1]) : y;
+    tft.fillRect(x, min(y, from), HISTORY_COL_W, abs(y - from) + 2, historyMetrics[m].color);
+  }
+}
 
-      int16_t x1, y1;
-      uint16_t w, h;
+// History job steps
+#define HISTORY_ALL 0 // every column, after the screen was cleared
+#define HISTORY_NEW 1 // new samples, each with the cursor and the oldest column after it
 
-      tft.getTextBounds(word, 0, 0, &x1, &y1, &w, &h);
+bool historySlice(RenderJob &job)
+{
+  if (historyInvalid)
+  {
+    // (Re)start the full pass; it covers everything recorded so far
+    historyInvalid = false;
+    historyDrawn = historyHead;
+    job.index = 0;
+    job.phase = HISTORY_ALL;
+  }
 
-      // Wrap if needed
-      if (cursorX + w > maxX)
-      {
-        cursorX = boxX + margin;
-        cursorY += h + 6;
-      }
+  if (job.phase == HISTORY_ALL)
+  {
+    for (uint8_t n = 0; n < HISTORY_COLS_PER_SLICE && job.index < HISTORY_LEN; n++)
+    {
+      historyColumn(job.index++);
+    }
+    if (job.index >= HISTORY_LEN)
+    {
+      job.phase = HISTORY_NEW;
+    }
+    return false;
+  }
 
-      // Stop if exceeding box height
-      if (cursorY + h > maxY)
-      {
-        return;
-      }
+  if (historyDrawn == historyHead)
+  {
+    return true; // up to date
+  }
 
-      tft.setCursor(cursorX, cursorY);
-      tft.print(word);
-      tft.print(" ");
+  historyColumn(historyDrawn);
+  historyDrawn = (historyDrawn + 1) % HISTORY_LEN;
+  historyColumn(historyDrawn); // moves the cursor on
+  historyColumn((historyDrawn + 1) % HISTORY_LEN); // the oldest no longer joins the cursor slot
+  return false;
+}
 
-      cursorX += w + 6;
-      wordIndex = 0;
+// Draw one glyph cell (background included) through a single address window.
+// GFX text at size 3 costs one fillRect, i.e. one address window, per lit
+// pixel; here the cell is streamed row by row in one burst instead.
+void blitGlyph(int16_t x, int16_t y, char c, uint8_t scale, uint16_t color, uint16_t bg)
+{
+  uint16_t row[BIGFONT_CELL_W * STAT_VALUE_SIZE]; // widest cell drawn
+  uint8_t columns[BIGFONT_CELL_W];
+  int16_t w = BIGFONT_CELL_W * scale;
 
-      if (c == '\0')
-        break;
+  for (uint8_t col = 0; col < BIGFONT_CELL_W; col++)
+  {
+    columns[col] = bigFontColumn(c, col);
+  }
+
+  tft.setAddrWindow(x, y, x + w - 1, y + BIGFONT_H * scale - 1);
+  for (uint8_t r = 0; r < BIGFONT_H; r++)
+  {
+    uint8_t mask = 1 << r;
+    for (int16_t i = 0; i < w; i++)
+    {
+      row[i] = (columns[i / scale] & mask) ? color : bg;
     }
-    else
+
+    // Each font row is `scale` identical screen rows
+    for (uint8_t i = 0; i < scale; i++)
     {
-      if (wordIndex < 39)
-      { // prevent overflow
-        word[wordIndex++] = c;
-      }
+      tft.pushColors(row, w, r == 0 && i == 0);
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+// Print the next word of a wrapped message; returns true when done
+bool wrapSlice(RenderJob &job)
+{
+  LayoutBox box;
+  box.width = job.w - 2 * WRAP_MARGIN;
+  box.maxLines = (job.h - 2 * WRAP_MARGIN - WRAP_CHAR_H) / WRAP_LINE_H + 1;
+  box.charW = WRAP_CHAR_W;
+  box.gap = WRAP_GAP;
+
+  // Laid out on the first slice (or the first time the message is shown)
+  const TextLayout &layout = layouts.get(job.text, box);
+  if (job.phase >= layout.lineCount)
+  {
+    return true;
+  }
+
+  const char *line = job.text + layout.start[job.phase];
+  uint8_t length = layout.length[job.phase];
+
+  if (job.index == 0)
+  {
+    job.cursorX = job.x + WRAP_MARGIN;
+    job.cursorY = job.y + WRAP_MARGIN + job.phase * WRAP_LINE_H;
+  }
+
+  tft.setTextSize(WRAP_SIZE);
+  tft.setTextColor(job.color);
+  tft.setCursor(job.cursorX, job.cursorY);
+
+  uint8_t i = job.index;
+  while (i < length && line[i] != ' ')
+  {
+    tft.write(line[i]);
+    job.cursorX += WRAP_CHAR_W;
+    i++;
+  }
+
+  if (i < length)
+  {
+    // Next word on the same line
+    while (line[i] == ' ')
+    {
+      i++;
     }
+    job.cursorX += WRAP_GAP;
+    job.index = i;
+    return false;
+  }
+
+  job.phase++;
+  job.index = 0;
+  if (job.phase < layout.lineCount)
+  {
+    return false;
+  }
+
+  if (layout.truncated)
+  {
+    tft.print(F(LAYOUT_ELLIPSIS));
   }
-}
\ No newline at end of file
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------------------------
+// Do one bounded piece of queued drawing; returns false when there is nothing to draw
+bool renderSlice()
+{
+  if (jobCount == 0)
+  {
+    return false;
+  }
+
+  RenderJob &job = jobs[jobHead];
+  bool done = true;
+
+  switch (job.kind)
+  {
+  case JOB_FILL:
+  {
+    int16_t rows = max(1, min(SLICE_PIXELS / job.w, job.h));
+    tft.fillRect(job.x, job.y, job.w, rows, job.color);
+    job.y += rows;
+    job.h -= rows;
+    done = (job.h <= 0);
+    break;
+  }
+  case JOB_OUTLINE:
+    tft.drawRect(job.x, job.y, job.w, job.h, job.color);
+    break;
+  case JOB_FACE:
+    faceSlice(job);
+    break;
+  case JOB_WRAP:
+    done = wrapSlice(job);
+    break;
+  case JOB_STATS:
+    done = statsSlice(job);
+    break;
+  case JOB_TILES:
+    done = tilesSlice(job);
+    break;
+  case JOB_HISTORY:
+    done = historySlice(job);
+    break;
+  case JOB_LABEL:
+    for (uint8_t i = 0; job.text[i]; i++)
+    {
+      blitGlyph(job.x + i * BIGFONT_CELL_W * TILE_LABEL_SIZE, job.y, job.text[i], TILE_LABEL_SIZE, job.color, BLACK);
+    }
+    break;
+  }
+
+  if (done)
+  {
+    jobHead = (jobHead + 1) % JOB_QUEUE_SIZE;
+    jobCount--;
+  }
+  return true;
+}
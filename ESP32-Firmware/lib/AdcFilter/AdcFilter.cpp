@@ -0,0 +1,51 @@
+#include "AdcFilter.h"
+
+AdcFilter::AdcFilter(const AdcFilterConfig &config)
+    : _config(config),
+      _primed(false),
+      _average(0),
+      _lastMedian(0) {
+}
+
+// Insertion sort: a burst is a few dozen readings at most
+static uint16_t median(const uint16_t *raw, uint8_t n) {
+    uint16_t sorted[ADC_FILTER_MAX_BURST];
+    for (uint8_t i = 0; i < n; i++) {
+        uint16_t v = raw[i];
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    return sorted[n / 2];
+}
+
+uint16_t AdcFilter::add(const uint16_t *raw, uint8_t n) {
+    if (n == 0) {
+        return value();
+    }
+    if (n > ADC_FILTER_MAX_BURST) {
+        n = ADC_FILTER_MAX_BURST;
+    }
+
+    _lastMedian = median(raw, n);
+    int32_t scaled = (int32_t)_lastMedian << 8;
+    if (!_primed) {
+        _average = scaled;
+        _primed = true;
+    } else {
+        _average += (scaled - _average) >> _config.emaShift;
+    }
+    return value();
+}
+
+int8_t moisturePercent(uint16_t counts, const MoistureCalibration &calibration) {
+    int32_t span = (int32_t)calibration.dry - calibration.wet;
+    if (span == 0) {
+        return -1;
+    }
+    int32_t percent = ((int32_t)calibration.dry - counts) * 100 / span;
+    return percent < 0 ? 0 : percent > 100 ? 100 : (int8_t)percent;
+}
@@ -0,0 +1,55 @@
+/**
+ * Noise filter for the moisture ADC, in integer arithmetic.
+ *
+ * Each sample is a burst of raw readings taken back to back: the median of
+ * the burst throws out the ESP32 ADC's spikes, and an exponential moving
+ * average across bursts (weight 1/2^emaShift for the newest) smooths what
+ * is left. The average is kept in 1/256 counts so small steps still move it.
+ *
+ * moisturePercent() maps filtered counts onto 0-100 % between a dry and a
+ * wet reading of the probe, whichever of the two reads higher.
+ *
+ * No clock, no pins: the caller reads the ADC and passes the burst in, so
+ * the filter runs the same on the host (see src/adc_bench.cpp).
+ */
+
+#ifndef ADC_FILTER_H
+#define ADC_FILTER_H
+
+#include <stdint.h>
+
+#define ADC_FILTER_MAX_BURST 31
+
+struct AdcFilterConfig {
+    uint8_t burst;     // readings per sample, odd, up to ADC_FILTER_MAX_BURST
+    uint8_t emaShift;  // 0 = no averaging, 2 = newest burst weighs 1/4
+};
+
+struct MoistureCalibration {
+    uint16_t dry;  // counts in dry air / dry soil
+    uint16_t wet;  // counts in water / soaked soil
+};
+
+class AdcFilter {
+public:
+    AdcFilter(const AdcFilterConfig &config);
+
+    uint8_t burst() const { return _config.burst; }
+
+    // Filter one burst of n raw readings; returns the new value()
+    uint16_t add(const uint16_t *raw, uint8_t n);
+    uint16_t value() const { return (uint16_t)((_average + 128) >> 8); }
+    uint16_t lastMedian() const { return _lastMedian; }
+    void reset() { _primed = false; }
+
+private:
+    AdcFilterConfig _config;
+    bool _primed;
+    int32_t _average;  // counts * 256
+    uint16_t _lastMedian;
+};
+
+// 0-100 %, or -1 if the two endpoints are the same
+int8_t moisturePercent(uint16_t counts, const MoistureCalibration &calibration);
+
+#endif
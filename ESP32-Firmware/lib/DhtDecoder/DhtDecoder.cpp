@@ -0,0 +1,105 @@
+#include "DhtDecoder.h"
+
+#include <math.h>
+
+static bool inRange(uint16_t us, uint16_t min, uint16_t max) {
+    return us >= min && us <= max;
+}
+
+static bool isResponse(const DhtSpan *spans) {
+    return spans[0].level == 0 && inRange(spans[0].us, DHT_RESPONSE_MIN_US, DHT_RESPONSE_MAX_US) &&
+           spans[1].level == 1 && inRange(spans[1].us, DHT_RESPONSE_MIN_US, DHT_RESPONSE_MAX_US);
+}
+
+DhtStatus dhtDecode(const DhtSpan *spans, size_t count, DhtModel model, DhtReading *reading) {
+    // Skip whatever the capture saw before the sensor answered
+    size_t i = 0;
+    while (i + 1 < count && !isResponse(spans + i)) {
+        i++;
+    }
+    if (i + 1 >= count) {
+        return DHT_NO_RESPONSE;
+    }
+    i += 2;
+
+    uint8_t data[5] = {0, 0, 0, 0, 0};
+    for (int bit = 0; bit < 40; bit++, i += 2) {
+        if (i + 1 >= count) {
+            return DHT_TIMEOUT;
+        }
+        const DhtSpan &low = spans[i];
+        const DhtSpan &high = spans[i + 1];
+        if (low.level != 0 || high.level != 1 || !inRange(low.us, DHT_BIT_LOW_MIN_US, DHT_BIT_LOW_MAX_US) ||
+            !inRange(high.us, DHT_BIT_HIGH_MIN_US, DHT_BIT_HIGH_MAX_US)) {
+            return DHT_BAD_PULSE;
+        }
+        data[bit / 8] = (data[bit / 8] << 1) | (high.us > DHT_BIT_ONE_US ? 1 : 0);
+    }
+
+    if ((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) {
+        return DHT_CHECKSUM;
+    }
+
+    if (model == DHT_MODEL_11) {
+        reading->humidity = data[0] + data[1] * 0.1f;
+        reading->temperature = data[2] + (data[3] & 0x7F) * 0.1f;
+        if (data[3] & 0x80) {
+            reading->temperature = -reading->temperature;
+        }
+    } else {
+        reading->humidity = ((data[0] << 8) | data[1]) * 0.1f;
+        reading->temperature = (((data[2] & 0x7F) << 8) | data[3]) * 0.1f;
+        if (data[2] & 0x80) {
+            reading->temperature = -reading->temperature;
+        }
+    }
+    for (int b = 0; b < 5; b++) {
+        reading->data[b] = data[b];
+    }
+    return DHT_OK;
+}
+
+const char *dhtStatusString(DhtStatus status) {
+    switch (status) {
+        case DHT_OK: return "OK";
+        case DHT_NO_RESPONSE: return "NO_RESPONSE";
+        case DHT_TIMEOUT: return "TIMEOUT";
+        case DHT_BAD_PULSE: return "BAD_PULSE";
+        case DHT_CHECKSUM: return "CHECKSUM";
+    }
+    return "UNKNOWN";
+}
+
+void dhtPack(DhtModel model, float temperature, float humidity, uint8_t data[5]) {
+    int t = (int)lroundf(fabsf(temperature) * 10);
+    int h = (int)lroundf(humidity * 10);
+    if (model == DHT_MODEL_11) {
+        data[0] = h / 10;
+        data[1] = h % 10;
+        data[2] = t / 10;
+        data[3] = (t % 10) | (temperature < 0 && t ? 0x80 : 0);
+    } else {
+        data[0] = h >> 8;
+        data[1] = h & 0xFF;
+        data[2] = ((t >> 8) & 0x7F) | (temperature < 0 && t ? 0x80 : 0);
+        data[3] = t & 0xFF;
+    }
+    data[4] = data[0] + data[1] + data[2] + data[3];
+}
+
+size_t dhtSynthesize(const uint8_t data[5], DhtSpan *spans, size_t max) {
+    if (max < DHT_FRAME_SPANS) {
+        return 0;
+    }
+    size_t n = 0;
+    spans[n++] = {30, 1};  // pull-up after the host lets go
+    spans[n++] = {80, 0};
+    spans[n++] = {80, 1};
+    for (int bit = 0; bit < 40; bit++) {
+        bool one = data[bit / 8] & (0x80 >> (bit % 8));
+        spans[n++] = {50, 0};
+        spans[n++] = {(uint16_t)(one ? 70 : 27), 1};
+    }
+    spans[n++] = {50, 0};
+    return n;
+}
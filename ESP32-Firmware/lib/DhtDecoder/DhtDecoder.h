@@ -0,0 +1,71 @@
+/**
+ * DHT11/DHT22 frame decoding, separate from capturing it.
+ *
+ * The board records the sensor's pulse train without blocking (the RMT
+ * peripheral timestamps every edge) and hands the spans to dhtDecode(),
+ * which finds the 80/80 us response, reads 40 bits by the length of each
+ * high pulse and checks the checksum. Nothing here touches a pin or the
+ * clock, so recorded or synthetic traces decode the same way on a host
+ * (see src/dht_bench.cpp).
+ *
+ * A frame after the host's start pulse:
+ *
+ *   ~~~|___80___|~~~80~~~|__50__|~26 or 70~|  x 40 bits  |__50__|~~~ idle
+ *      response            bit: 0 = 26-28 us high, 1 = 70 us high
+ */
+
+#ifndef DHT_DECODER_H
+#define DHT_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Spans in a nominal frame, with the released line before the response
+#define DHT_FRAME_SPANS 84
+
+// Timing tolerances (us); DHT11 parts run well off the datasheet values
+const uint16_t DHT_RESPONSE_MIN_US = 40;
+const uint16_t DHT_RESPONSE_MAX_US = 120;
+const uint16_t DHT_BIT_LOW_MIN_US = 30;
+const uint16_t DHT_BIT_LOW_MAX_US = 90;
+const uint16_t DHT_BIT_HIGH_MIN_US = 10;
+const uint16_t DHT_BIT_ONE_US = 48;       // longer high pulses are 1 bits
+const uint16_t DHT_BIT_HIGH_MAX_US = 100;
+
+enum DhtModel {
+    DHT_MODEL_11,   // 1 % and 0.1 C steps in separate bytes
+    DHT_MODEL_22    // 16-bit values in 0.1 steps
+};
+
+enum DhtStatus {
+    DHT_OK = 0,
+    DHT_NO_RESPONSE,  // no response pulse: sensor missing or the start was too short
+    DHT_TIMEOUT,      // the frame ended before 40 bits
+    DHT_BAD_PULSE,    // a pulse outside the tolerances above (noise, glitch)
+    DHT_CHECKSUM      // 40 bits, but they do not add up
+};
+
+// One level of the line and how long it lasted
+struct DhtSpan {
+    uint16_t us;
+    uint8_t level;
+};
+
+struct DhtReading {
+    float temperature;  // C
+    float humidity;     // %RH
+    uint8_t data[5];    // raw frame, checksum last
+};
+
+// Decode one captured frame. `reading` is only filled on DHT_OK.
+DhtStatus dhtDecode(const DhtSpan *spans, size_t count, DhtModel model, DhtReading *reading);
+const char *dhtStatusString(DhtStatus status);
+
+// The other direction, for simulations and benchmarks: the five bytes a
+// sensor sends for a reading, and the nominal pulse train for them.
+// dhtSynthesize() returns the number of spans written (DHT_FRAME_SPANS),
+// or 0 if `max` is too small.
+void dhtPack(DhtModel model, float temperature, float humidity, uint8_t data[5]);
+size_t dhtSynthesize(const uint8_t data[5], DhtSpan *spans, size_t max);
+
+#endif
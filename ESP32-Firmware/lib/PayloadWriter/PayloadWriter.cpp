@@ -0,0 +1,313 @@
+#include "PayloadWriter.h"
+
+#include <string.h>
+
+// CBOR major types (RFC 8949 section 3.1)
+#define CBOR_UINT 0
+#define CBOR_NEGINT 1
+#define CBOR_TEXT 3
+#define CBOR_ARRAY 4
+#define CBOR_MAP 5
+#define CBOR_FLOAT32 0xFA
+
+PayloadWriter::PayloadWriter(uint8_t *buf, size_t size, PayloadFormat format)
+    : _buf(buf), _size(size), _length(0), _overflow(false), _format(format), _added(0), _summarized(false) {
+}
+
+const char *PayloadWriter::contentType() const {
+    return _format == PAYLOAD_CBOR ? "application/cbor" : "application/json";
+}
+
+void PayloadWriter::begin(uint16_t count, bool withSummary) {
+    _length = 0;
+    _overflow = false;
+    _added = 0;
+    _summarized = false;
+
+    if (_format == PAYLOAD_CBOR) {
+        cborHead(CBOR_MAP, withSummary ? 2 : 1);
+        cborKey("samples");
+        cborHead(CBOR_ARRAY, count);
+    } else {
+        putText("{\"samples\":[");
+    }
+}
+
+void PayloadWriter::add(const Sample &sample, uint32_t ageMs) {
+    if (_format == PAYLOAD_CBOR) {
+        uint8_t pairs = 1;
+        for (uint8_t bit = SAMPLE_TEMP; bit & (SAMPLE_ALL | SAMPLE_BOOT); bit <<= 1) {
+            if (sample.fields & bit) {
+                pairs++;
+            }
+        }
+        if ((sample.fields & SAMPLE_MOIST) && sample.moisturePct >= 0) {
+            pairs++;
+        }
+        if (sample.channel) {
+            pairs++;
+        }
+
+        cborHead(CBOR_MAP, pairs);
+        cborKey("age_ms");
+        cborHead(CBOR_UINT, ageMs);
+        if (sample.channel) {
+            cborKey("ch");
+            cborHead(CBOR_UINT, sample.channel);
+        }
+        if (sample.fields & SAMPLE_TEMP) {
+            cborKey("temp");
+            cborFloat(sample.temp);
+        }
+        if (sample.fields & SAMPLE_HUMID) {
+            cborKey("humidity");
+            cborInt((int32_t)sample.humidity);
+        }
+        if (sample.fields & SAMPLE_MOIST) {
+            cborKey("moisture");
+            cborInt(sample.moisture);
+            if (sample.moisturePct >= 0) {
+                cborKey("moisture_pct");
+                cborInt(sample.moisturePct);
+            }
+        }
+        if (sample.fields & SAMPLE_BOOT) {
+            cborKey("boot_ms");
+            cborHead(CBOR_UINT, sample.takenAt);
+        }
+    } else {
+        if (_added > 0) {
+            put(',');
+        }
+        putText("{\"age_ms\":");
+        putDecimal(ageMs);
+        if (sample.channel) {
+            putText(",\"ch\":");
+            putDecimal(sample.channel);
+        }
+        if (sample.fields & SAMPLE_TEMP) {
+            putText(",\"temp\":");
+            putTenths(sample.temp);
+        }
+        if (sample.fields & SAMPLE_HUMID) {
+            putText(",\"humidity\":");
+            putInt((int32_t)sample.humidity);
+        }
+        if (sample.fields & SAMPLE_MOIST) {
+            putText(",\"moisture\":");
+            putInt(sample.moisture);
+            if (sample.moisturePct >= 0) {
+                putText(",\"moisture_pct\":");
+                putDecimal(sample.moisturePct);
+            }
+        }
+        if (sample.fields & SAMPLE_BOOT) {
+            putText(",\"boot_ms\":");
+            putDecimal(sample.takenAt);
+        }
+        put('}');
+    }
+    _added++;
+}
+
+void PayloadWriter::summary(const Summary &summary, uint32_t ageMs) {
+    if (_format == PAYLOAD_CBOR) {
+        uint8_t pairs = 2;
+        if (summary.channel) {
+            pairs++;
+        }
+        if (summary.fields & SAMPLE_TEMP) {
+            pairs += 4;
+        }
+        if (summary.fields & SAMPLE_HUMID) {
+            pairs++;
+        }
+        if (summary.fields & SAMPLE_MOIST) {
+            pairs += summary.hoursToDry >= 0 ? 6 : 5;
+        }
+
+        cborKey("summary");
+        cborHead(CBOR_MAP, pairs);
+        cborKey("age_ms");
+        cborHead(CBOR_UINT, ageMs);
+        if (summary.channel) {
+            cborKey("ch");
+            cborHead(CBOR_UINT, summary.channel);
+        }
+        cborKey("n");
+        cborHead(CBOR_UINT, summary.window);
+        if (summary.fields & SAMPLE_TEMP) {
+            cborKey("temp_min");
+            cborFloat(summary.tempMin);
+            cborKey("temp_max");
+            cborFloat(summary.tempMax);
+            cborKey("temp_mean");
+            cborFloat(summary.tempMean);
+            cborKey("temp_sd");
+            cborFloat(summary.tempStddev);
+        }
+        if (summary.fields & SAMPLE_HUMID) {
+            cborKey("humidity_mean");
+            cborFloat(summary.humidityMean);
+        }
+        if (summary.fields & SAMPLE_MOIST) {
+            cborKey("moisture_min");
+            cborInt(summary.moistureMin);
+            cborKey("moisture_max");
+            cborInt(summary.moistureMax);
+            cborKey("moisture_mean");
+            cborFloat(summary.moistureMean);
+            cborKey("moisture_sd");
+            cborFloat(summary.moistureStddev);
+            cborKey("moisture_per_hour");
+            cborFloat(summary.moisturePerHour);
+            if (summary.hoursToDry >= 0) {
+                cborKey("dry_in_h");
+                cborFloat(summary.hoursToDry);
+            }
+        }
+    } else {
+        putText("],\"summary\":{\"age_ms\":");
+        putDecimal(ageMs);
+        if (summary.channel) {
+            putText(",\"ch\":");
+            putDecimal(summary.channel);
+        }
+        putText(",\"n\":");
+        putDecimal(summary.window);
+        if (summary.fields & SAMPLE_TEMP) {
+            putField("temp_min", summary.tempMin);
+            putField("temp_max", summary.tempMax);
+            putField("temp_mean", summary.tempMean);
+            putField("temp_sd", summary.tempStddev);
+        }
+        if (summary.fields & SAMPLE_HUMID) {
+            putField("humidity_mean", summary.humidityMean);
+        }
+        if (summary.fields & SAMPLE_MOIST) {
+            putText(",\"moisture_min\":");
+            putInt(summary.moistureMin);
+            putText(",\"moisture_max\":");
+            putInt(summary.moistureMax);
+            putField("moisture_mean", summary.moistureMean);
+            putField("moisture_sd", summary.moistureStddev);
+            putField("moisture_per_hour", summary.moisturePerHour);
+            if (summary.hoursToDry >= 0) {
+                putField("dry_in_h", summary.hoursToDry);
+            }
+        }
+        put('}');
+    }
+    _summarized = true;
+}
+
+size_t PayloadWriter::finish() {
+    if (_format == PAYLOAD_JSON) {
+        putText(_summarized ? "}" : "]}");
+    }
+    return _overflow ? 0 : _length;
+}
+
+void PayloadWriter::put(uint8_t b) {
+    if (_length < _size) {
+        _buf[_length++] = b;
+    } else {
+        _overflow = true;
+    }
+}
+
+void PayloadWriter::putText(const char *s) {
+    while (*s) {
+        put(*s++);
+    }
+}
+
+void PayloadWriter::putDecimal(uint32_t value) {
+    char digits[10];
+    uint8_t n = 0;
+
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    while (n) {
+        put(digits[--n]);
+    }
+}
+
+// One decimal, rounded like String(value, 1)
+void PayloadWriter::putTenths(float value) {
+    float tenths = value * 10;
+    if (!(tenths > -1e9f)) {  // also catches NaN
+        tenths = -1e9f;
+    } else if (tenths > 1e9f) {
+        tenths = 1e9f;
+    }
+
+    uint32_t magnitude = (uint32_t)((tenths < 0 ? -tenths : tenths) + 0.5f);
+    if (tenths < 0 && magnitude) {
+        put('-');
+    }
+    putDecimal(magnitude / 10);
+    put('.');
+    put('0' + magnitude % 10);
+}
+
+void PayloadWriter::putInt(int32_t value) {
+    if (value < 0) {
+        put('-');
+    }
+    putDecimal(value < 0 ? -(uint32_t)value : value);
+}
+
+void PayloadWriter::putField(const char *key, float value) {
+    put(',');
+    put('"');
+    putText(key);
+    putText("\":");
+    putTenths(value);
+}
+
+void PayloadWriter::cborHead(uint8_t major, uint32_t value) {
+    major <<= 5;
+    if (value < 24) {
+        put(major | value);
+    } else if (value <= 0xFF) {
+        put(major | 24);
+        put(value);
+    } else if (value <= 0xFFFF) {
+        put(major | 25);
+        put(value >> 8);
+        put(value);
+    } else {
+        put(major | 26);
+        put(value >> 24);
+        put(value >> 16);
+        put(value >> 8);
+        put(value);
+    }
+}
+
+void PayloadWriter::cborKey(const char *key) {
+    cborHead(CBOR_TEXT, strlen(key));
+    putText(key);
+}
+
+void PayloadWriter::cborInt(int32_t value) {
+    if (value < 0) {
+        cborHead(CBOR_NEGINT, (uint32_t)(-(value + 1)));
+    } else {
+        cborHead(CBOR_UINT, value);
+    }
+}
+
+void PayloadWriter::cborFloat(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    put(CBOR_FLOAT32);
+    put(bits >> 24);
+    put(bits >> 16);
+    put(bits >> 8);
+    put(bits);
+}
@@ -0,0 +1,91 @@
+/**
+ * Encodes sample batches for POST /sensor/batch into a caller's buffer.
+ *
+ * Writes either the JSON body ({"samples":[{"age_ms":..,"temp":..},..]})
+ * or the same structure as CBOR (RFC 8949), straight into a fixed buffer:
+ * no String, no heap. A buffer of PAYLOAD_SIZE(n) bytes always fits a batch
+ * of n samples in either format.
+ *
+ * Samples and summaries carry "ch", the channel (plant) they belong to,
+ * unless it is 0.
+ *
+ * A batch may also carry one summary: rolling statistics the hub computed
+ * over its recent samples ({"samples":[..],"summary":{..}}).
+ *
+ * Usage:
+ *   PayloadWriter payload(buf, sizeof(buf), PAYLOAD_JSON);
+ *   payload.begin(count, withSummary);
+ *   payload.add(sample, ageMs);   // count times
+ *   payload.summary(summary, ageMs);  // if withSummary
+ *   size_t length = payload.finish();
+ */
+
+#ifndef PAYLOAD_WRITER_H
+#define PAYLOAD_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <SampleRing.h>
+
+#define PAYLOAD_SAMPLE_MAX 144  // Longest JSON sample, separator included
+#define PAYLOAD_SUMMARY_MAX 368  // Longest JSON summary, key included
+#define PAYLOAD_SIZE(n) (16 + (n) * PAYLOAD_SAMPLE_MAX + PAYLOAD_SUMMARY_MAX)
+
+// Rolling statistics over the last `window` samples (lib/RollingStats)
+struct Summary {
+    uint32_t takenAt;        // millis() when computed
+    uint8_t channel;
+    uint8_t fields;          // SAMPLE_* bits of the figures below that are filled in
+    uint16_t window;         // samples the figures cover
+    float tempMin;
+    float tempMax;
+    float tempMean;
+    float tempStddev;
+    float humidityMean;
+    int32_t moistureMin;
+    int32_t moistureMax;
+    float moistureMean;
+    float moistureStddev;
+    float moisturePerHour;   // least-squares trend
+    float hoursToDry;        // until the trend reaches the dry threshold, 0 if already dry, < 0 if not drying
+};
+
+enum PayloadFormat {
+    PAYLOAD_JSON,
+    PAYLOAD_CBOR
+};
+
+class PayloadWriter {
+public:
+    PayloadWriter(uint8_t *buf, size_t size, PayloadFormat format);
+
+    const char *contentType() const;
+
+    void begin(uint16_t count, bool withSummary = false);  // count = number of add() calls to follow
+    void add(const Sample &sample, uint32_t ageMs);
+    void summary(const Summary &summary, uint32_t ageMs);
+    size_t finish();             // payload length, 0 if it did not fit
+
+private:
+    void put(uint8_t b);
+    void putText(const char *s);
+    void putDecimal(uint32_t value);
+    void putTenths(float value);
+    void putInt(int32_t value);
+    void putField(const char *key, float value);  // ,"key":12.3
+
+    void cborHead(uint8_t major, uint32_t value);
+    void cborKey(const char *key);
+    void cborInt(int32_t value);
+    void cborFloat(float value);
+
+    uint8_t *_buf;
+    size_t _size;
+    size_t _length;
+    bool _overflow;
+    PayloadFormat _format;
+    uint16_t _added;
+    bool _summarized;
+};
+
+#endif
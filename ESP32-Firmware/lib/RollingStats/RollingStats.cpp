@@ -0,0 +1,139 @@
+#include "RollingStats.h"
+
+RollingStats::RollingStats(uint8_t window)
+    : _window(window == 0 ? 1 : window > ROLLING_MAX ? ROLLING_MAX : window) {
+    clear();
+}
+
+void RollingStats::clear() {
+    _count = 0;
+    _seq = 0;
+    _origin = 0;
+    _sumY = _sumYY = _sumT = _sumTT = _sumTY = 0;
+    _minQueue.head = _minQueue.length = 0;
+    _maxQueue.head = _maxQueue.length = 0;
+}
+
+void RollingStats::push(MonotonicQueue &queue, uint32_t seq, bool keepLower) {
+    int32_t value = valueAt(seq);
+
+    // Drop the readings the new one makes irrelevant, from the back
+    while (queue.length) {
+        int32_t last = valueAt(queue.seqs[(queue.head + queue.length - 1) % ROLLING_MAX]);
+        if (keepLower ? last < value : last > value) {
+            break;
+        }
+        queue.length--;
+    }
+    queue.seqs[(queue.head + queue.length) % ROLLING_MAX] = seq;
+    queue.length++;
+
+    // and the one that left the window, from the front
+    if (seq - queue.seqs[queue.head] >= _window) {
+        queue.head = (queue.head + 1) % ROLLING_MAX;
+        queue.length--;
+    }
+}
+
+// Move the origin up to the oldest reading in the window. The sums shift
+// exactly: with t' = t - d, sum(t') = sum(t) - n d, sum(t'^2) = sum(t^2) -
+// 2 d sum(t) + n d^2 and sum(t' y) = sum(t y) - d sum(y).
+void RollingStats::rebase() {
+    uint32_t d = _times[(_seq - _count) % _window];
+    if (d == 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < _count; i++) {
+        _times[i] -= d;
+    }
+    int64_t n = _count;
+    _sumTT -= 2 * (int64_t)d * _sumT - n * d * d;
+    _sumT -= n * d;
+    _sumTY -= (int64_t)d * _sumY;
+    _origin += d;
+}
+
+void RollingStats::add(uint32_t seconds, int32_t value) {
+    if (_seq == 0) {
+        _origin = seconds;
+    }
+    uint8_t slot = _seq % _window;
+    if (_count == _window) {
+        int64_t y = _values[slot];
+        int64_t t = _times[slot];
+        _sumY -= y;
+        _sumYY -= y * y;
+        _sumT -= t;
+        _sumTT -= t * t;
+        _sumTY -= t * y;
+    } else {
+        _count++;
+    }
+
+    int64_t y = value;
+    int64_t t = (uint32_t)(seconds - _origin);
+    _values[slot] = value;
+    _times[slot] = (uint32_t)t;
+    _sumY += y;
+    _sumYY += y * y;
+    _sumT += t;
+    _sumTT += t * t;
+    _sumTY += t * y;
+
+    push(_minQueue, _seq, true);
+    push(_maxQueue, _seq, false);
+    _seq++;
+
+    if (t >= (int64_t)ROLLING_REBASE_S) {
+        rebase();
+    }
+}
+
+int32_t RollingStats::min() const {
+    return _count ? valueAt(_minQueue.seqs[_minQueue.head]) : 0;
+}
+
+int32_t RollingStats::max() const {
+    return _count ? valueAt(_maxQueue.seqs[_maxQueue.head]) : 0;
+}
+
+float RollingStats::mean() const {
+    return _count ? (float)_sumY / _count : 0;
+}
+
+float RollingStats::variance() const {
+    if (_count < 2) {
+        return 0;
+    }
+    // n * sum(y^2) - sum(y)^2 is exact in 64 bits, then one division
+    int64_t spread = (int64_t)_count * _sumYY - _sumY * _sumY;
+    return (float)spread / ((float)_count * _count);
+}
+
+float RollingStats::slopePerHour() const {
+    int64_t spreadT = (int64_t)_count * _sumTT - _sumT * _sumT;
+    if (_count < 2 || spreadT <= 0) {
+        return 0;
+    }
+    int64_t covariance = (int64_t)_count * _sumTY - _sumT * _sumY;
+    return (float)covariance / (float)spreadT * 3600.0f;
+}
+
+float RollingStats::hoursUntilBelow(int32_t level) const {
+    if (_count == 0) {
+        return -1;
+    }
+    // The fitted line at the newest reading, not the (noisy) reading itself
+    float slope = slopePerHour();
+    float meanT = (float)_sumT / _count;
+    float newestT = _times[(_seq - 1) % _window];
+    float fitted = mean() + slope * (newestT - meanT) / 3600.0f;
+
+    if (fitted <= level) {
+        return 0;
+    }
+    if (slope >= 0) {
+        return -1;
+    }
+    return (level - fitted) / slope;
+}
@@ -0,0 +1,73 @@
+/**
+ * Rolling statistics over the last `window` readings of one value.
+ *
+ * Every add() is O(1): min and max come from monotonic queues (amortized
+ * O(1)), and mean, variance and the least-squares slope against time from
+ * running sums that take the new reading in and the one leaving the window
+ * out. The sums are 64-bit integers, so nothing drifts however long it runs;
+ * times are kept relative to an origin that moves up with the window, so
+ * the squared times stay far from overflow.
+ *
+ * Values are integers (scale them first, e.g. temperature in tenths) and
+ * times are seconds from a clock that does not wrap (not millis() / 1000).
+ * hoursUntilBelow() extrapolates the fitted line down to a level, e.g. how
+ * long until the soil reaches the dry threshold.
+ *
+ * No clock: callers pass the time in, so recorded traces replay the same
+ * on a host.
+ */
+
+#ifndef ROLLING_STATS_H
+#define ROLLING_STATS_H
+
+#include <stdint.h>
+
+#define ROLLING_MAX 64              // Longest window
+#define ROLLING_REBASE_S (1UL << 20)  // Move the origin once times get this far from it (12 days)
+
+class RollingStats {
+public:
+    RollingStats(uint8_t window);  // readings, up to ROLLING_MAX
+
+    void clear();
+    void add(uint32_t seconds, int32_t value);  // times must not go backwards
+
+    uint8_t count() const { return _count; }
+    int32_t min() const;
+    int32_t max() const;
+    float mean() const;
+    float variance() const;  // population variance
+    float slopePerHour() const;  // 0 until two readings at different times
+
+    // Hours until the fitted line falls to `level`: 0 if it is already
+    // there or below, -1 if it is not falling
+    float hoursUntilBelow(int32_t level) const;
+
+private:
+    // Queue of sequence numbers whose values only rise (min) or fall (max)
+    struct MonotonicQueue {
+        uint32_t seqs[ROLLING_MAX];
+        uint8_t head;
+        uint8_t length;
+    };
+
+    void push(MonotonicQueue &queue, uint32_t seq, bool keepLower);
+    void rebase();
+    int32_t valueAt(uint32_t seq) const { return _values[seq % _window]; }
+
+    uint8_t _window;
+    uint8_t _count;
+    uint32_t _seq;       // readings added since clear()
+    uint32_t _origin;    // times are kept relative to this (the oldest reading, at most)
+    int32_t _values[ROLLING_MAX];
+    uint32_t _times[ROLLING_MAX];
+    int64_t _sumY;
+    int64_t _sumYY;
+    int64_t _sumT;
+    int64_t _sumTT;
+    int64_t _sumTY;
+    MonotonicQueue _minQueue;
+    MonotonicQueue _maxQueue;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include "SampleRing.h"
+
+static const uint32_t RING_MAGIC = 0x53524E04;  // "SRN" + layout version, bump when Sample changes
+
+void SampleRing::clear() {
+    _magic = RING_MAGIC;
+    _head = 0;
+    _count = 0;
+}
+
+bool SampleRing::valid() const {
+    return _magic == RING_MAGIC && _head < SAMPLE_RING_SIZE && _count <= SAMPLE_RING_SIZE;
+}
+
+bool SampleRing::push(const Sample &sample) {
+    bool kept = true;
+
+    if (_count == SAMPLE_RING_SIZE) {
+        drop(1);
+        kept = false;
+    }
+    _samples[(_head + _count) % SAMPLE_RING_SIZE] = sample;
+    _count++;
+    return kept;
+}
+
+const Sample &SampleRing::at(uint16_t index) const {
+    return _samples[(_head + index) % SAMPLE_RING_SIZE];
+}
+
+void SampleRing::drop(uint16_t n) {
+    if (n > _count) {
+        n = _count;
+    }
+    _head = (_head + n) % SAMPLE_RING_SIZE;
+    _count -= n;
+}
+
+void SampleRing::rebase() {
+    for (uint16_t i = 0; i < _count; i++) {
+        Sample &sample = _samples[(_head + i) % SAMPLE_RING_SIZE];
+        sample.takenAt = 0;
+        sample.fields &= ~SAMPLE_BOOT;
+    }
+}
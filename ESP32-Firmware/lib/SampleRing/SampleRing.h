@@ -0,0 +1,60 @@
+/**
+ * Store-and-forward buffer for sensor samples.
+ *
+ * A fixed ring of the most recent samples, oldest first. Samples are only
+ * removed once the server has taken them, so a WiFi or server outage costs
+ * nothing as long as it is shorter than SAMPLE_RING_SIZE samples; after
+ * that the oldest ones are overwritten.
+ *
+ * The ring has no constructor so it can live in RTC_NOINIT memory and
+ * survive a soft reset: check valid() at boot and clear() if it is not.
+ */
+
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stdint.h>
+
+#define SAMPLE_RING_SIZE 200  // ~6.5 min at one sample per 2 s
+
+// Sample::fields, for the values that are reported
+#define SAMPLE_TEMP 0x01
+#define SAMPLE_HUMID 0x02
+#define SAMPLE_MOIST 0x04
+#define SAMPLE_ALL (SAMPLE_TEMP | SAMPLE_HUMID | SAMPLE_MOIST)
+#define SAMPLE_BOOT 0x08  // First sample since boot: takenAt is the boot-to-sample time
+
+struct Sample {
+    float temp;
+    float humidity;
+    int moisture;
+    uint32_t takenAt;  // millis() when sampled
+    uint8_t fields;    // SAMPLE_* bits of the values that changed
+    int8_t moisturePct;  // calibrated moisture 0-100, -1 if not calibrated
+    uint8_t channel;     // plant the readings belong to
+};
+
+class SampleRing {
+public:
+    void clear();
+    bool valid() const;  // false for uninitialized (e.g. power-on) memory
+
+    // Append a sample; returns false if the oldest one had to be overwritten
+    bool push(const Sample &sample);
+
+    uint16_t count() const { return _count; }
+    const Sample &at(uint16_t index) const;  // 0 = oldest
+    void drop(uint16_t n);                    // remove the n oldest
+
+    // After a reset millis() starts over: mark the kept samples as taken
+    // at boot, i.e. at least as old as the uptime (clears SAMPLE_BOOT)
+    void rebase();
+
+private:
+    uint32_t _magic;
+    uint16_t _head;  // oldest sample
+    uint16_t _count;
+    Sample _samples[SAMPLE_RING_SIZE];
+};
+
+#endif
@@ -0,0 +1,48 @@
+#include "SampleScheduler.h"
+
+#include <math.h>
+
+SampleScheduler::SampleScheduler(const SchedulerConfig &config)
+    : _config(config),
+      _interval(config.minIntervalMs),
+      _nextAt(0),
+      _stable(0),
+      _primed(false),
+      _lastAt(0),
+      _lastTemp(0),
+      _lastMoisture(0) {
+}
+
+uint32_t SampleScheduler::waitMs(uint32_t now) const {
+    return due(now) ? 0 : _nextAt - now;
+}
+
+bool SampleScheduler::changing(uint32_t elapsed, float delta, float noise, float perMin) const {
+    delta = fabsf(delta);
+    return delta > noise && delta * 60000.0f > perMin * elapsed;
+}
+
+void SampleScheduler::record(uint32_t now, float temp, int moisture) {
+    if (_primed) {
+        uint32_t elapsed = now - _lastAt;
+        bool moving = changing(elapsed, temp - _lastTemp, _config.tempNoise, _config.tempPerMin) ||
+                      changing(elapsed, (float)(moisture - _lastMoisture), _config.moistureNoise,
+                               _config.moisturePerMin);
+
+        if (moving) {
+            // Catch up right away
+            _interval = _config.minIntervalMs;
+            _stable = 0;
+        } else if (++_stable >= _config.stableSamples) {
+            // Back off exponentially while nothing happens
+            _interval = _interval > _config.maxIntervalMs / 2 ? _config.maxIntervalMs : _interval * 2;
+            _stable = 0;
+        }
+    }
+
+    _primed = true;
+    _lastAt = now;
+    _lastTemp = temp;
+    _lastMoisture = moisture;
+    _nextAt = now + _interval;
+}
@@ -0,0 +1,57 @@
+/**
+ * Adaptive sampling cadence for the sensor hub.
+ *
+ * Samples come every minIntervalMs while temperature or moisture is moving,
+ * and the interval doubles (up to maxIntervalMs) after every stableSamples
+ * readings in a row that did not. A reading counts as moving when it
+ * changed by more than the noise floor and faster than the configured rate.
+ *
+ * The scheduler never reads the clock itself: callers pass `now` in, so it
+ * runs the same against millis() on the board and a simulated clock or a
+ * recorded trace on a host.
+ */
+
+#ifndef SAMPLE_SCHEDULER_H
+#define SAMPLE_SCHEDULER_H
+
+#include <stdint.h>
+
+struct SchedulerConfig {
+    uint32_t minIntervalMs;   // cadence while readings are changing
+    uint32_t maxIntervalMs;   // back-off cap
+    float tempPerMin;         // faster than this counts as changing (C/min)
+    float moisturePerMin;     // (ADC counts/min)
+    float tempNoise;          // changes up to this are ignored
+    float moistureNoise;
+    uint8_t stableSamples;    // stable readings before the interval doubles
+};
+
+class SampleScheduler {
+public:
+    SampleScheduler(const SchedulerConfig &config);
+
+    bool due(uint32_t now) const { return (int32_t)(now - _nextAt) >= 0; }
+    uint32_t waitMs(uint32_t now) const;  // 0 when due
+    uint32_t interval() const { return _interval; }
+
+    // Feed a reading taken at now; sets the time of the next one
+    void record(uint32_t now, float temp, int moisture);
+    // The reading failed: try again after minIntervalMs, interval unchanged
+    void retry(uint32_t now) { _nextAt = now + _config.minIntervalMs; }
+    // First reading at `at` instead of right away, to stagger sensors
+    void startAt(uint32_t at) { _nextAt = at; }
+
+private:
+    bool changing(uint32_t elapsed, float delta, float noise, float perMin) const;
+
+    SchedulerConfig _config;
+    uint32_t _interval;
+    uint32_t _nextAt;
+    uint8_t _stable;      // stable readings since the last change of interval
+    bool _primed;
+    uint32_t _lastAt;
+    float _lastTemp;
+    int _lastMoisture;
+};
+
+#endif
@@ -0,0 +1,229 @@
+#include "UnoLink.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// True if a cumulative ack for `acked` covers `seq` (mod 256)
+static bool seqCovers(uint8_t acked, uint8_t seq) {
+    return (uint8_t)(acked - seq) < 128;
+}
+
+UnoLink::UnoLink(Writer writer, uint8_t window, uint32_t ackTimeoutMs)
+    : _writer(writer),
+      _window(window < 1 ? 1 : window > UNO_LINK_MAX_WINDOW ? UNO_LINK_MAX_WINDOW : window),
+      _ackTimeoutMs(ackTimeoutMs),
+      _head(0),
+      _count(0),
+      _nextSeq(0),
+      _busy(false),
+      _lastProgress(0),
+      _retries(0),
+      _pendingChannels(0),
+      _nextChannel(0),
+      _replyLen(0) {
+    memset(_pending, 0, sizeof(_pending));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void UnoLink::begin() {
+    _head = 0;
+    _count = 0;
+    _nextSeq = 0;
+    _busy = false;
+    _retries = 0;
+    _writer("R\n", 2);
+}
+
+void UnoLink::send(const Sample &sample) {
+    if (sample.channel >= UNO_LINK_CHANNELS) {
+        return;
+    }
+    Pending &pending = _pending[sample.channel];
+    uint8_t fields = sample.fields & SAMPLE_ALL;
+
+    for (uint8_t bit = SAMPLE_TEMP; bit <= SAMPLE_MOIST; bit <<= 1) {
+        if (fields & pending.fields & bit) {
+            _stats.replaced++;
+        }
+    }
+    if (fields & SAMPLE_TEMP) {
+        pending.temp = sample.temp;
+    }
+    if (fields & SAMPLE_HUMID) {
+        pending.humidity = sample.humidity;
+    }
+    if (fields & SAMPLE_MOIST) {
+        pending.moisture = sample.moisture;
+    }
+    pending.fields |= fields;
+    if (pending.fields) {
+        _pendingChannels |= 1u << sample.channel;
+    }
+}
+
+void UnoLink::poll(uint32_t now) {
+    // No ack in time: a lost command, ack or RDY. Go back and resend.
+    if (_count > 0 && now - _lastProgress >= _ackTimeoutMs) {
+        _stats.timeouts++;
+        _busy = false;
+        if (++_retries > UNO_LINK_RETRIES) {
+            _stats.dropped += _count;
+            _count = 0;
+            _retries = 0;
+        } else {
+            resendFrom(inFlight(0).seq, now);
+        }
+    }
+
+    // One channel's fields at a time, channels in turn
+    while (_pendingChannels && !_busy && _count < _window) {
+        while (!(_pendingChannels & (1u << _nextChannel))) {
+            _nextChannel = (_nextChannel + 1) % UNO_LINK_CHANNELS;
+        }
+        Pending &pending = _pending[_nextChannel];
+        char prefix[8] = "S";
+        if (_nextChannel != 0) {
+            snprintf(prefix, sizeof(prefix), "S%u", _nextChannel);
+        }
+
+        Command &command = inFlight(_count);
+        int len;
+        if (pending.fields & SAMPLE_TEMP) {
+            len = snprintf(command.line, UNO_LINK_LINE_MAX, "%s T %.1f", prefix, pending.temp);
+            pending.fields &= ~SAMPLE_TEMP;
+        } else if (pending.fields & SAMPLE_HUMID) {
+            len = snprintf(command.line, UNO_LINK_LINE_MAX, "%s H %d", prefix, (int)pending.humidity);
+            pending.fields &= ~SAMPLE_HUMID;
+        } else {
+            len = snprintf(command.line, UNO_LINK_LINE_MAX, "%s M %d", prefix, pending.moisture);
+            pending.fields &= ~SAMPLE_MOIST;
+        }
+        if (!pending.fields) {
+            _pendingChannels &= ~(1u << _nextChannel);
+            _nextChannel = (_nextChannel + 1) % UNO_LINK_CHANNELS;
+        }
+        if (len < 0 || len >= UNO_LINK_LINE_MAX) {
+            // A value no sensor gives; cut short it would show a wrong one
+            _stats.dropped++;
+            continue;
+        }
+
+        if (_count == 0) {
+            _lastProgress = now;
+        }
+        _count++;
+        command.seq = _nextSeq++;
+        command.len = len;
+        write(command);
+        _stats.sent++;
+    }
+}
+
+void UnoLink::receive(char c, uint32_t now) {
+    if (c == '\r') {
+        return;
+    }
+    if (c != '\n') {
+        if (_replyLen < UNO_LINK_REPLY_MAX - 1) {
+            _reply[_replyLen++] = c;
+        }
+        return;
+    }
+    _reply[_replyLen] = '\0';
+    _replyLen = 0;
+    handleReply(now);
+}
+
+// ACK/BUSY <seq> <depth>, RDY <depth>, NAK <seq> SEQ|CRC|BAD; anything
+// else (OK replies, boot messages) is not for us
+void UnoLink::handleReply(uint32_t now) {
+    char *rest = strchr(_reply, ' ');
+    if (!rest) {
+        return;
+    }
+    *rest++ = '\0';
+    char *end;
+    long value = strtol(rest, &end, 10);
+    if (end == rest || value < 0 || value > 255) {
+        return;
+    }
+    uint8_t seq = value;
+
+    if (strcmp(_reply, "RDY") == 0) {
+        _busy = false;
+        _lastProgress = now;
+    } else if (strcmp(_reply, "ACK") == 0 || strcmp(_reply, "BUSY") == 0) {
+        if (_count > 0 && seqCovers(seq, inFlight(0).seq) && (uint8_t)(seq - inFlight(0).seq) >= _count) {
+            // Past anything in flight: the Uno's sequence is not ours
+            resync(now);
+            return;
+        }
+        ack(seq, now);
+        _busy = _reply[0] == 'B';
+        if (_busy) {
+            _stats.busy++;
+            _lastProgress = now;  // waiting for RDY, not for acks
+        }
+    } else if (strcmp(_reply, "NAK") == 0) {
+        _stats.naks++;
+        if (strstr(end, "BAD")) {
+            ack(seq, now);  // consumed but rejected, resending would not help
+        } else {
+            resendFrom(seq, now);
+        }
+    }
+}
+
+void UnoLink::ack(uint8_t seq, uint32_t now) {
+    bool progress = false;
+
+    while (_count > 0 && seqCovers(seq, inFlight(0).seq)) {
+        _head = (_head + 1) % UNO_LINK_MAX_WINDOW;
+        _count--;
+        _stats.acked++;
+        progress = true;
+    }
+    if (progress) {
+        _lastProgress = now;
+        _retries = 0;
+    }
+}
+
+// Go back to `seq` and resend the window. If the Uno expects a seq we never
+// sent (it was reset), renumber the window from there.
+void UnoLink::resendFrom(uint8_t seq, uint32_t now) {
+    uint8_t i = 0;
+    while (i < _count && inFlight(i).seq != seq) {
+        i++;
+    }
+    if (i < _count) {
+        ack(seq - 1, now);
+    } else {
+        for (i = 0; i < _count; i++) {
+            inFlight(i).seq = seq + i;
+        }
+        _nextSeq = seq + _count;
+    }
+
+    for (i = 0; i < _count; i++) {
+        write(inFlight(i));
+        _stats.resent++;
+    }
+    _lastProgress = now;
+}
+
+// Restart the Uno's sequence and resend the window; its first command
+// starts the new one
+void UnoLink::resync(uint32_t now) {
+    _stats.resyncs++;
+    _busy = false;
+    _writer("R\n", 2);
+    resendFrom(inFlight(0).seq, now);
+}
+
+void UnoLink::write(const Command &command) {
+    char buf[UNO_LINK_LINE_MAX + 8];
+    int len = snprintf(buf, sizeof(buf), "#%u %.*s\n", command.seq, command.len, command.line);
+    _writer(buf, len);
+}
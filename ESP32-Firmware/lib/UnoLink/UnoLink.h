@@ -0,0 +1,107 @@
+/**
+ * Drives the Uno LCD straight from the hub over a UART, no server needed.
+ *
+ * Samples become the Uno's text commands (S T/S H/S M, or S<ch> T... for
+ * any channel but 0), tagged with a sequence number and sent with the Uno's windowed acks (see "Windowed Acks"
+ * in shared/protocol.md): up to `window` commands in flight, cumulative
+ * ACKs, BUSY/RDY to back off while the LCD catches up, NAK to go back and
+ * resend, and a resend of the whole window when acks stop coming.
+ *
+ * A value that has not been sent yet is replaced by a newer one of the same
+ * field and channel, so a slow or disconnected Uno never makes the hub
+ * buffer more than one command per field and channel. Channels with
+ * something to send take turns.
+ *
+ * begin() sends an untagged R so the Uno, which may have kept running
+ * through a hub reset, takes the next tagged command as the start of a new
+ * sequence. An ack for a seq that was never sent means the Uno is still on
+ * an old one (the R was lost): the link sends R again and resends.
+ *
+ * The link does no I/O of its own: bytes from the Uno go into receive(),
+ * commands go out through the writer, and callers pass the time in.
+ */
+
+#ifndef UNO_LINK_H
+#define UNO_LINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <SampleRing.h>
+
+#define UNO_LINK_MAX_WINDOW 8
+#define UNO_LINK_CHANNELS 16   // as many as the Uno's table; others are dropped
+#define UNO_LINK_LINE_MAX 16   // "S15 T -123.4", without the tag
+#define UNO_LINK_REPLY_MAX 24
+#define UNO_LINK_RETRIES 3     // ack timeouts before the window is dropped
+
+struct UnoLinkStats {
+    uint32_t sent;        // commands, first transmissions
+    uint32_t resent;
+    uint32_t acked;
+    uint32_t replaced;    // unsent values overtaken by newer ones
+    uint32_t naks;
+    uint32_t busy;
+    uint32_t timeouts;
+    uint32_t dropped;     // given up on after UNO_LINK_RETRIES timeouts, or too long to send
+    uint32_t resyncs;     // R sent after an ack for a seq never sent
+};
+
+class UnoLink {
+public:
+    typedef void (*Writer)(const char *data, size_t len);
+
+    UnoLink(Writer writer, uint8_t window, uint32_t ackTimeoutMs);
+
+    void begin();                               // new sequence on the Uno, from seq 0
+    void send(const Sample &sample);            // fields in sample.fields
+    void receive(char c, uint32_t now);         // a byte from the Uno
+    void poll(uint32_t now);                    // sends and resends what is due
+
+    bool idle() const { return _count == 0 && !_pendingChannels; }
+    uint8_t nextSeq() const { return _nextSeq; }
+    const UnoLinkStats &stats() const { return _stats; }
+
+private:
+    struct Command {
+        uint8_t seq;
+        uint8_t len;
+        char line[UNO_LINK_LINE_MAX];
+    };
+
+    struct Pending {
+        float temp;
+        uint8_t humidity;
+        int moisture;
+        uint8_t fields;     // SAMPLE_* bits not sent yet
+    };
+
+    void handleReply(uint32_t now);
+    void ack(uint8_t seq, uint32_t now);
+    void resendFrom(uint8_t seq, uint32_t now);
+    void resync(uint32_t now);
+    void write(const Command &command);
+    Command &inFlight(uint8_t i) { return _inFlight[(_head + i) % UNO_LINK_MAX_WINDOW]; }
+
+    Writer _writer;
+    uint8_t _window;
+    uint32_t _ackTimeoutMs;
+
+    Command _inFlight[UNO_LINK_MAX_WINDOW];  // oldest at _head
+    uint8_t _head;
+    uint8_t _count;
+    uint8_t _nextSeq;
+    bool _busy;                              // BUSY until RDY
+    uint32_t _lastProgress;                  // last ack, or first send into an empty window
+    uint8_t _retries;
+
+    Pending _pending[UNO_LINK_CHANNELS];     // newest unsent values per channel
+    uint16_t _pendingChannels;               // bit per channel with fields to send
+    uint8_t _nextChannel;                    // the next to get a turn
+
+    char _reply[UNO_LINK_REPLY_MAX];
+    uint8_t _replyLen;
+
+    UnoLinkStats _stats;
+};
+
+#endif
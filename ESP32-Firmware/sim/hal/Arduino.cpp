@@ -0,0 +1,239 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include "Sim.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+
+static std::chrono::steady_clock::time_point clockStart = std::chrono::steady_clock::now();
+static std::mutex serialLock;
+static std::mt19937 rng(1);
+static std::mutex rngLock;
+
+// ---------------------------------------------------------------- clock
+
+void simStartClock() {
+    clockStart = std::chrono::steady_clock::now();
+}
+
+uint64_t simHostMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - clockStart)
+        .count();
+}
+
+static uint64_t hostMicrosAt(double simMs) {
+    return (uint64_t)(simMs * 1000.0 / simConfig.speed);
+}
+
+void simSleepMs(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::microseconds(hostMicrosAt(ms)));
+}
+
+unsigned long millis() {
+    return (unsigned long)(simHostMicros() * simConfig.speed / 1000.0);
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)(simHostMicros() * simConfig.speed);
+}
+
+// Only loop() calls delay(), so its overshoot is the loop's wake-up jitter
+// and the time since the last one returned is what one pass took
+void delay(unsigned long ms) {
+    static uint64_t lastWoke = 0;
+    uint64_t called = simHostMicros();
+    uint64_t deadline = called + hostMicrosAt(ms);
+    std::this_thread::sleep_until(clockStart + std::chrono::microseconds(deadline));
+
+    uint64_t woke = simHostMicros();
+    std::lock_guard<std::mutex> guard(simStats.lock);
+    simStats.overshootUs.push_back((uint32_t)(woke - deadline));
+    if (lastWoke) {
+        simStats.busyUs.push_back((uint32_t)(called - lastWoke));
+    }
+    lastWoke = woke;
+}
+
+long random(long howbig) {
+    return howbig > 0 ? random(0, howbig) : 0;
+}
+
+long random(long howsmall, long howbig) {
+    if (howsmall >= howbig) {
+        return howsmall;
+    }
+    std::lock_guard<std::mutex> guard(rngLock);
+    return howsmall + (long)(rng() % (uint32_t)(howbig - howsmall));
+}
+
+uint32_t esp_random() {
+    std::lock_guard<std::mutex> guard(rngLock);
+    return rng();
+}
+
+esp_reset_reason_t esp_reset_reason() {
+    return (esp_reset_reason_t)simConfig.resetReason;
+}
+
+// ---------------------------------------------------------------- Serial
+
+void HardwareSerial::begin(unsigned long baud) {
+}
+
+// Bytes pass at host speed, not the simulated clock: keep --speed low
+// enough that the Uno's replies beat the firmware's ack timeout
+void HardwareSerial::begin(unsigned long baud, uint32_t config, int8_t rxPin, int8_t txPin) {
+    if (!simConfig.unoPath) {
+        return;
+    }
+    _fd = open(simConfig.unoPath, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    termios tio;
+    if (_fd < 0 || tcgetattr(_fd, &tio) != 0) {
+        perror("[Sim] --uno");
+        exit(1);
+    }
+    cfmakeraw(&tio);
+    tcsetattr(_fd, TCSANOW, &tio);
+}
+
+int HardwareSerial::available() {
+    if (_peeked < 0) {
+        _peeked = read();
+    }
+    return _peeked >= 0 ? 1 : 0;
+}
+
+int HardwareSerial::read() {
+    if (_peeked >= 0) {
+        int c = _peeked;
+        _peeked = -1;
+        return c;
+    }
+    uint8_t c;
+    return _fd >= 0 && ::read(_fd, &c, 1) == 1 ? c : -1;
+}
+
+size_t HardwareSerial::write(const uint8_t *data, size_t len) {
+    if (_fd >= 0 && ::write(_fd, data, len) < 0) {
+        return 0;
+    }
+    return len;
+}
+
+size_t HardwareSerial::printf(const char *format, ...) {
+    char buf[512];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    return print(buf) ? (size_t)len : 0;
+}
+
+size_t HardwareSerial::print(const char *s) {
+    if (simConfig.quiet) {
+        return strlen(s);
+    }
+    std::lock_guard<std::mutex> guard(serialLock);
+    return fputs(s, stdout) >= 0 ? strlen(s) : 0;
+}
+
+// ---------------------------------------------------------------- FreeRTOS
+
+struct SimQueue {
+    std::mutex lock;
+    std::condition_variable changed;
+    std::deque<std::string> items;
+    size_t length;
+    size_t itemSize;
+};
+
+// Wait for pred under the queue lock, for up to `wait` simulated ms
+template <class Pred>
+static bool waitFor(SimQueue *queue, std::unique_lock<std::mutex> &guard, TickType_t wait, Pred pred) {
+    if (wait == portMAX_DELAY) {
+        queue->changed.wait(guard, pred);
+        return true;
+    }
+    return queue->changed.wait_for(guard, std::chrono::microseconds(hostMicrosAt(wait)), pred);
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    SimQueue *queue = new SimQueue;
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait) {
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!waitFor(queue, guard, wait, [queue] { return queue->items.size() < queue->length; })) {
+        return pdFALSE;
+    }
+    queue->items.push_back(std::string((const char *)item, queue->itemSize));
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+static BaseType_t take(QueueHandle_t queue, void *item, TickType_t wait, bool remove) {
+    std::unique_lock<std::mutex> guard(queue->lock);
+    if (!waitFor(queue, guard, wait, [queue] { return !queue->items.empty(); })) {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    if (remove) {
+        queue->items.pop_front();
+        queue->changed.notify_all();
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait) {
+    return take(queue, item, wait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t wait) {
+    return take(queue, item, wait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> guard(queue->lock);
+    return queue->items.size();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stackSize, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+    std::thread(task, param).detach();
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    simSleepMs(ticks);
+}
+
+// ---------------------------------------------------------------- Preferences
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+    _values[key].assign((const uint8_t *)value, (const uint8_t *)value + len);
+    return len;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+    std::map<std::string, std::vector<uint8_t> >::const_iterator it = _values.find(key);
+    if (it == _values.end() || it->second.size() > maxLen) {
+        return 0;
+    }
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
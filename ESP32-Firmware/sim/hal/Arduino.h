@@ -0,0 +1,94 @@
+/**
+ * Host stand-in for the Arduino-ESP32 core: just enough of Arduino,
+ * Serial, String and FreeRTOS for temphumid.cpp, on a simulated clock.
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define RTC_NOINIT_ATTR
+
+// Same semantics as the core's std::min/max: both arguments one type
+template <class T> T min(T a, T b) { return b < a ? b : a; }
+template <class T> T max(T a, T b) { return a < b ? b : a; }
+
+class String {
+public:
+    String(const char *s = "") : _s(s) {}
+    String(const std::string &s) : _s(s) {}
+    const char *c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+private:
+    std::string _s;
+};
+
+#define SERIAL_8N1 0x800001c
+
+// Serial is the console (stdout). Serial1 talks to whatever --uno names,
+// e.g. the pty of the Uno LCD host build; with no --uno its output is dropped.
+class HardwareSerial {
+public:
+    void begin(unsigned long baud);
+    void begin(unsigned long baud, uint32_t config, int8_t rxPin, int8_t txPin);
+    int available();
+    int read();
+    size_t write(const uint8_t *data, size_t len);
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char *s);
+    size_t print(const String &s) { return print(s.c_str()); }
+    size_t print(int n) { return printf("%d", n); }
+    size_t print(unsigned int n) { return printf("%u", n); }
+    size_t print(long n) { return printf("%ld", n); }
+    size_t print(unsigned long n) { return printf("%lu", n); }
+    size_t print(double n, int digits = 2) { return printf("%.*f", digits, n); }
+    template <class T> size_t println(T value) { return print(value) + print("\n"); }
+    template <class T> size_t println(T value, int digits) { return print(value, digits) + print("\n"); }
+    size_t println() { return print("\n"); }
+
+private:
+    int _fd = -1;
+    int _peeked = -1;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+unsigned long millis();
+void delay(unsigned long ms);
+int analogRead(uint8_t pin);
+long random(long howbig);
+long random(long howsmall, long howbig);
+uint32_t esp_random();
+
+// FreeRTOS, one tick per ms
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void (*TaskFunction_t)(void *);
+typedef void *TaskHandle_t;
+typedef struct SimQueue *QueueHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portMAX_DELAY 0xFFFFFFFFu
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait);
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stackSize, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+
+#endif
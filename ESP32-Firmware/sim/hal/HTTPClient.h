@@ -0,0 +1,44 @@
+/**
+ * HTTP/1.1 POST over WiFiClient with keep-alive, like the core's
+ * HTTPClient with setReuse(true). Every request goes to
+ * simConfig.serverHost:serverPort; only the URL's path is kept.
+ */
+
+#ifndef HTTPCLIENT_H
+#define HTTPCLIENT_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+#define HTTP_CODE_OK 200
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+class HTTPClient {
+public:
+    HTTPClient() : _client(NULL), _reuse(true), _timeoutMs(5000) {}
+
+    bool begin(WiFiClient &client, const char *url);
+    void setReuse(bool reuse) { _reuse = reuse; }
+    void setTimeout(uint16_t timeoutMs) { _timeoutMs = timeoutMs; }
+    void addHeader(const char *name, const char *value);
+    int POST(uint8_t *payload, size_t size);
+    String getString() { return String(_body); }
+    void end();
+    static String errorToString(int error);
+
+private:
+    int request(const uint8_t *payload, size_t size);
+
+    WiFiClient *_client;
+    bool _reuse;
+    bool _keepAlive;
+    uint16_t _timeoutMs;
+    std::string _path;
+    std::string _headers;
+    std::string _body;
+};
+
+#endif
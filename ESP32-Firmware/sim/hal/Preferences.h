@@ -0,0 +1,19 @@
+// In-memory NVS: empty at every start, like a board after an erase
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <vector>
+
+class Preferences {
+public:
+    bool begin(const char *name, bool readOnly = false) { return true; }
+    void end() {}
+    size_t putBytes(const char *key, const void *value, size_t len);
+    size_t getBytes(const char *key, void *buf, size_t maxLen);
+private:
+    std::map<std::string, std::vector<uint8_t> > _values;
+};
+
+#endif
@@ -0,0 +1,250 @@
+// Sensors fed from the sim trace (see Sim.h): the moisture ADC, and a DHT11
+// that answers the firmware's start pulse with a pulse train recorded by a
+// stand-in for the RMT receiver, so the firmware's capture and decoder run
+// unchanged. Every pin is a sensor of its own plant: its readings are the
+// trace's, offset by a fixed amount per pin.
+
+#include <Arduino.h>
+#include <DhtDecoder.h>
+#include <driver/rmt.h>
+#include "Sim.h"
+
+#include <stdio.h>
+#include <vector>
+
+struct TraceRow {
+    uint32_t ms;
+    float temp;
+    float humidity;
+    int moisture;
+};
+
+static std::vector<TraceRow> trace;
+static bool traceLoaded = false;
+static std::mutex traceLock;
+
+static void loadTrace() {
+    traceLoaded = true;
+    if (!simConfig.tracePath) {
+        return;
+    }
+
+    FILE *file = fopen(simConfig.tracePath, "r");
+    if (!file) {
+        fprintf(stderr, "[Sim] Cannot open trace %s\n", simConfig.tracePath);
+        exit(1);
+    }
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        TraceRow row;
+        if (line[0] != '#' && sscanf(line, "%u,%f,%f,%d", &row.ms, &row.temp, &row.humidity, &row.moisture) == 4) {
+            trace.push_back(row);
+        }
+    }
+    fclose(file);
+}
+
+uint32_t simTraceRows() {
+    std::lock_guard<std::mutex> guard(traceLock);
+    if (!traceLoaded) {
+        loadTrace();
+    }
+    return trace.size();
+}
+
+// The trace row in effect at `now` (rows are held until the next one); a
+// slowly drying plant with a daily temperature swing when there is no trace
+static TraceRow readingAt(unsigned long now) {
+    std::lock_guard<std::mutex> guard(traceLock);
+    if (!traceLoaded) {
+        loadTrace();
+    }
+
+    if (trace.empty()) {
+        double hours = now / 3600000.0;
+        TraceRow row;
+        row.ms = now;
+        row.temp = 22 + 3 * sin(hours * 2 * M_PI / 24);
+        row.humidity = 45 - 8 * sin(hours * 2 * M_PI / 24);
+        row.moisture = 2600 - (int)(hours * 120);
+        return row;
+    }
+
+    size_t i = 0;
+    while (i + 1 < trace.size() && trace[i + 1].ms <= now) {
+        i++;
+    }
+    return trace[i];
+}
+
+// -5..5, the same for a pin every time
+static int pinOffset(int pin) {
+    return pin * 7 % 11 - 5;
+}
+
+// The ESP32 ADC: a few dozen counts of noise on every read, and the odd
+// spike of a few hundred
+int analogRead(uint8_t pin) {
+    int counts = readingAt(millis()).moisture + pinOffset(pin) * 40 + random(-25, 26) + random(-25, 26);
+    if (random(100) < 2) {
+        counts += random(-400, 401);
+    }
+    return counts < 0 ? 0 : counts > 4095 ? 4095 : counts;
+}
+
+// ---------------------------------------------------------------- DHT11 on RMT
+
+const uint32_t DHT_MIN_START_MS = 18;   // shorter start pulses go unanswered
+const uint32_t DHT_FRAME_MS = 5;        // response + 40 bits + end
+const int DHT_JITTER_US = 8;
+
+static std::mutex rmtLock;
+static bool rmtRunning = false;
+static int rmtPin = -1;
+static uint32_t lineLowAt = 0;
+static bool lineLow = false;
+static bool framePending = false;
+static uint32_t frameReadyAt = 0;
+static std::vector<rmt_item32_t> frameItems;
+static std::vector<rmt_item32_t> frameTaken;
+
+static void addSpan(std::vector<DhtSpan> &spans, DhtSpan span) {
+    int us = span.us + random(-DHT_JITTER_US, DHT_JITTER_US + 1);
+    span.us = us < 1 ? 1 : us;
+    spans.push_back(span);
+}
+
+// What the sensor on `pin` sends for the reading at `now`, with timing
+// jitter and, at simConfig.dhtErrorRate, one of the faults seen on long
+// sensor wires
+static void makeFrame(int pin, uint32_t now) {
+    TraceRow row = readingAt(now);
+    uint8_t data[5];
+    dhtPack(DHT_MODEL_11, row.temp + pinOffset(pin) * 0.4f, row.humidity + pinOffset(pin), data);
+    DhtSpan nominal[DHT_FRAME_SPANS];
+    size_t count = dhtSynthesize(data, nominal, DHT_FRAME_SPANS);
+
+    std::vector<DhtSpan> spans;
+    for (size_t i = 0; i < count; i++) {
+        addSpan(spans, nominal[i]);
+    }
+
+    if (random(1000000) < simConfig.dhtErrorRate * 1000000) {
+        switch (random(4)) {
+            case 0: {  // a flipped bit
+                DhtSpan &high = spans[4 + 2 * random(40)];
+                high.us = high.us > DHT_BIT_ONE_US ? 27 : 70;
+                break;
+            }
+            case 1:  // the frame stops short
+                spans.resize(3 + 2 * random(1, 40));
+                break;
+            case 2:  // a stretched pulse
+                spans[3 + random(80)].us = 150;
+                break;
+            default:  // no answer at all
+                spans.clear();
+                break;
+        }
+        std::lock_guard<std::mutex> guard(simStats.lock);
+        simStats.dhtFaults++;
+    }
+
+    // Pair levels into RMT items; a zero duration ends the frame
+    frameItems.clear();
+    for (size_t i = 0; i < spans.size(); i += 2) {
+        rmt_item32_t item;
+        item.val = 0;
+        item.duration0 = spans[i].us;
+        item.level0 = spans[i].level;
+        if (i + 1 < spans.size()) {
+            item.duration1 = spans[i + 1].us;
+            item.level1 = spans[i + 1].level;
+        }
+        frameItems.push_back(item);
+    }
+    if (!frameItems.empty() && frameItems.back().duration1) {
+        rmt_item32_t end;
+        end.val = 0;
+        frameItems.push_back(end);
+    }
+    framePending = !frameItems.empty();
+    frameReadyAt = now + DHT_FRAME_MS;
+
+    std::lock_guard<std::mutex> guard(simStats.lock);
+    simStats.reads++;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode) {
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_pull_mode(gpio_num_t gpio, gpio_pull_mode_t pull) {
+    return ESP_OK;
+}
+
+// Releasing the line after a long enough start pulse makes the sensor answer,
+// heard if the RMT receiver is on that pin. One DHT line is low at a time.
+esp_err_t gpio_set_level(gpio_num_t gpio, uint32_t level) {
+    std::lock_guard<std::mutex> guard(rmtLock);
+    uint32_t now = millis();
+    if (!level) {
+        lineLow = true;
+        lineLowAt = now;
+    } else if (lineLow) {
+        lineLow = false;
+        if (rmtRunning && gpio == rmtPin && now - lineLowAt >= DHT_MIN_START_MS) {
+            makeFrame(gpio, now);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_config(const rmt_config_t *config) {
+    std::lock_guard<std::mutex> guard(rmtLock);
+    rmtPin = config->gpio_num;
+    return ESP_OK;
+}
+
+esp_err_t rmt_set_gpio(rmt_channel_t channel, rmt_mode_t mode, gpio_num_t gpio_num, bool invert_signal) {
+    std::lock_guard<std::mutex> guard(rmtLock);
+    rmtPin = gpio_num;
+    return ESP_OK;
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags) {
+    return ESP_OK;
+}
+
+esp_err_t rmt_get_ringbuf_handle(rmt_channel_t channel, RingbufHandle_t *buf_handle) {
+    *buf_handle = (RingbufHandle_t)&frameItems;
+    return ESP_OK;
+}
+
+esp_err_t rmt_rx_start(rmt_channel_t channel, bool rx_idx_rst) {
+    std::lock_guard<std::mutex> guard(rmtLock);
+    rmtRunning = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_rx_stop(rmt_channel_t channel) {
+    std::lock_guard<std::mutex> guard(rmtLock);
+    rmtRunning = false;
+    framePending = false;
+    return ESP_OK;
+}
+
+// Only non-blocking receives, which is all the firmware does
+void *xRingbufferReceive(RingbufHandle_t ring, size_t *size, TickType_t wait) {
+    std::lock_guard<std::mutex> guard(rmtLock);
+    if (!framePending || (int32_t)(millis() - frameReadyAt) < 0) {
+        return NULL;
+    }
+    framePending = false;
+    frameTaken = frameItems;
+    *size = frameTaken.size() * sizeof(rmt_item32_t);
+    return frameTaken.data();
+}
+
+void vRingbufferReturnItem(RingbufHandle_t ring, void *item) {
+}
@@ -0,0 +1,53 @@
+/**
+ * Knobs and measurements shared by the host HAL and sim_main.cpp.
+ *
+ * The simulated clock runs `speed` times faster than the host clock:
+ * millis(), delay() and FreeRTOS timeouts are all scaled, so an hour of
+ * sampling fits in a minute. Sockets stay real (loopback).
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <mutex>
+#include <vector>
+
+struct SimConfig {
+    double speed;               // simulated ms per host ms
+    const char *tracePath;      // CSV: ms,temp,humidity,moisture; NULL for a synthetic plant
+    const char *serverHost;     // every HTTP request goes here, whatever the URL says
+    int serverPort;
+    bool quiet;                 // hide the firmware's Serial output
+    int resetReason;            // esp_reset_reason_t reported at boot
+    uint32_t wifiConnectMs;     // full join: 1/2 scan, 1/6 association, 1/3 DHCP; a cached
+                                // channel and BSSID skip the scan, a static IP skips DHCP
+    uint32_t wifiDropEveryMs;   // drop the link this often (0 = never)
+    uint32_t wifiDropMs;        // and keep the AP away for this long
+    const char *unoPath;        // Serial1 device (UNO_LINK builds), NULL to drop its output
+    double dhtErrorRate;        // fraction of DHT frames with a fault (bad bit, cut short, glitch, none)
+};
+
+struct SimStats {
+    std::mutex lock;
+    uint32_t reads;             // DHT frames sent
+    uint32_t dhtFaults;         // of which broken on purpose
+    uint32_t posts;
+    uint32_t postErrors;
+    uint32_t drops;
+    std::vector<uint32_t> postUs;     // host time per POST, request to response
+    std::vector<uint32_t> overshootUs; // host time delay() slept past its deadline
+    std::vector<uint32_t> busyUs;      // host time per loop() pass, delay() aside
+};
+
+extern SimConfig simConfig;
+extern SimStats simStats;
+
+void simStartClock();
+uint64_t simHostMicros();   // host time since simStartClock()
+void simSleepMs(uint32_t ms);  // simulated ms
+
+void simStartWiFi();        // event task and AP drop schedule
+uint32_t simTraceRows();
+
+#endif
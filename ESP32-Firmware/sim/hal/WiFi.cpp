@@ -0,0 +1,362 @@
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include "Sim.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <thread>
+#include <vector>
+
+WiFiClass WiFi;
+
+static const IPAddress DHCP_IP(192, 168, 4, 23);
+static const IPAddress GATEWAY_IP(192, 168, 4, 1);
+static const IPAddress SUBNET_MASK(255, 255, 255, 0);
+static uint8_t apBssid[6] = {0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56};
+static const int32_t AP_CHANNEL = 6;
+
+// Link state, shared by the firmware's tasks and the event thread
+static std::mutex wifiLock;
+static std::vector<WiFiEventCb> callbacks;
+static std::vector<arduino_event_id_t> pending;
+static bool linkUp = false;
+static bool joining = false;
+static unsigned long joinAt = 0;
+static unsigned long apAwayUntil = 0;
+static unsigned long nextDropAt = 0;
+static IPAddress staticIp;
+static uint32_t linkGeneration = 0;  // bumped on every drop: open sockets die with the link
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _address & 0xFF, (_address >> 8) & 0xFF, (_address >> 16) & 0xFF,
+             _address >> 24);
+    return String(buf);
+}
+
+// ---------------------------------------------------------------- event task
+
+static void dropLink() {
+    if (linkUp || joining) {
+        linkUp = false;
+        joining = false;
+        linkGeneration++;
+        pending.push_back(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    }
+}
+
+static void eventTask() {
+    for (;;) {
+        std::vector<arduino_event_id_t> events;
+        std::vector<WiFiEventCb> targets;
+        {
+            std::lock_guard<std::mutex> guard(wifiLock);
+            unsigned long now = millis();
+
+            if (simConfig.wifiDropEveryMs && (long)(now - nextDropAt) >= 0) {
+                nextDropAt = now + simConfig.wifiDropEveryMs;
+                apAwayUntil = now + simConfig.wifiDropMs;
+                if (linkUp) {
+                    std::lock_guard<std::mutex> stats(simStats.lock);
+                    simStats.drops++;
+                }
+                dropLink();
+            }
+
+            if (joining && (long)(now - joinAt) >= 0) {
+                if ((long)(now - apAwayUntil) < 0) {
+                    joining = false;  // AP not found
+                    pending.push_back(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+                } else {
+                    joining = false;
+                    linkUp = true;
+                    pending.push_back(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+                }
+            }
+
+            events.swap(pending);
+            targets = callbacks;
+        }
+
+        for (size_t i = 0; i < events.size(); i++) {
+            for (size_t j = 0; j < targets.size(); j++) {
+                targets[j](events[i]);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void simStartWiFi() {
+    nextDropAt = simConfig.wifiDropEveryMs;
+    std::thread(eventTask).detach();
+}
+
+// ---------------------------------------------------------------- WiFiClass
+
+int WiFiClass::onEvent(WiFiEventCb callback, arduino_event_id_t event) {
+    std::lock_guard<std::mutex> guard(wifiLock);
+    callbacks.push_back(callback);
+    return callbacks.size();
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *password, int32_t channel, const uint8_t *bssid,
+                             bool connect) {
+    std::lock_guard<std::mutex> guard(wifiLock);
+    uint32_t full = simConfig.wifiConnectMs;
+    uint32_t took = full / 6;
+    if (!(channel && bssid)) {
+        took += full / 2;
+    }
+    if (!staticIp) {
+        took += full / 3;
+    }
+
+    dropLink();
+    joining = true;
+    joinAt = millis() + took;
+    return WL_DISCONNECTED;
+}
+
+bool WiFiClass::config(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns) {
+    std::lock_guard<std::mutex> guard(wifiLock);
+    staticIp = ip;
+    return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+    std::lock_guard<std::mutex> guard(wifiLock);
+    dropLink();
+    return true;
+}
+
+wl_status_t WiFiClass::status() {
+    std::lock_guard<std::mutex> guard(wifiLock);
+    return linkUp ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+IPAddress WiFiClass::localIP() {
+    std::lock_guard<std::mutex> guard(wifiLock);
+    return !linkUp ? IPAddress() : staticIp ? staticIp : DHCP_IP;
+}
+
+IPAddress WiFiClass::gatewayIP() {
+    return GATEWAY_IP;
+}
+
+IPAddress WiFiClass::subnetMask() {
+    return SUBNET_MASK;
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t index) {
+    return GATEWAY_IP;
+}
+
+uint8_t *WiFiClass::BSSID() {
+    return apBssid;
+}
+
+int32_t WiFiClass::channel() {
+    return AP_CHANNEL;
+}
+
+// ---------------------------------------------------------------- WiFiClient
+
+int WiFiClient::connect(const char *host, uint16_t port, int timeoutMs) {
+    stop();
+
+    addrinfo hints, *addr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if (getaddrinfo(host, service, &hints, &addr) != 0) {
+        return 0;
+    }
+
+    _fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_fd >= 0 && ::connect(_fd, addr->ai_addr, addr->ai_addrlen) != 0) {
+        stop();
+    }
+    freeaddrinfo(addr);
+    if (_fd < 0) {
+        return 0;
+    }
+
+    int one = 1;
+    setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    _rx.clear();
+    return 1;
+}
+
+void WiFiClient::stop() {
+    if (_fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+}
+
+bool WiFiClient::write(const void *data, size_t len) {
+    const char *p = (const char *)data;
+    while (_fd >= 0 && len > 0) {
+        ssize_t n = send(_fd, p, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            stop();
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return _fd >= 0;
+}
+
+// Read whatever arrives within timeoutMs; bytes read, -1 on error or close
+int WiFiClient::fill(int timeoutMs) {
+    pollfd pfd = {_fd, POLLIN, 0};
+    if (_fd < 0 || poll(&pfd, 1, timeoutMs) <= 0) {
+        return -1;
+    }
+    char buf[1024];
+    ssize_t n = recv(_fd, buf, sizeof(buf), 0);
+    if (n <= 0) {
+        stop();
+        return -1;
+    }
+    _rx.append(buf, n);
+    return n;
+}
+
+int WiFiClient::readLine(std::string &line, int timeoutMs) {
+    size_t end;
+    while ((end = _rx.find("\r\n")) == std::string::npos) {
+        if (fill(timeoutMs) < 0) {
+            return -1;
+        }
+    }
+    line = _rx.substr(0, end);
+    _rx.erase(0, end + 2);
+    return line.size();
+}
+
+bool WiFiClient::readBytes(std::string &out, size_t len, int timeoutMs) {
+    while (_rx.size() < len) {
+        if (fill(timeoutMs) < 0) {
+            return false;
+        }
+    }
+    out = _rx.substr(0, len);
+    _rx.erase(0, len);
+    return true;
+}
+
+// ---------------------------------------------------------------- HTTPClient
+
+static uint32_t clientGeneration = 0;
+
+bool HTTPClient::begin(WiFiClient &client, const char *url) {
+    const char *path = strstr(url, "://");
+    path = strchr(path ? path + 3 : url, '/');
+    _client = &client;
+    _path = path ? path : "/";
+    _headers.clear();
+    _body.clear();
+    _keepAlive = true;
+    return true;
+}
+
+void HTTPClient::addHeader(const char *name, const char *value) {
+    _headers += std::string(name) + ": " + value + "\r\n";
+}
+
+int HTTPClient::request(const uint8_t *payload, size_t size) {
+    {
+        std::lock_guard<std::mutex> guard(wifiLock);
+        if (!linkUp) {
+            _client->stop();
+            return HTTPC_ERROR_CONNECTION_LOST;
+        }
+        if (clientGeneration != linkGeneration) {
+            _client->stop();  // The link dropped since this socket was opened
+            clientGeneration = linkGeneration;
+        }
+    }
+
+    std::string head = "POST " + _path + " HTTP/1.1\r\nHost: " + simConfig.serverHost +
+                       "\r\nConnection: keep-alive\r\nContent-Length: " + std::to_string(size) + "\r\n" +
+                       _headers + "\r\n";
+
+    // A reused connection may have been closed by the server: retry once on a new one
+    bool sent = false;
+    for (int attempt = 0; attempt < 2 && !sent; attempt++) {
+        if (!_client->connected() &&
+            !_client->connect(simConfig.serverHost, simConfig.serverPort, _timeoutMs)) {
+            return HTTPC_ERROR_CONNECTION_REFUSED;
+        }
+        sent = _client->write(head.data(), head.size()) && _client->write(payload, size);
+    }
+    if (!sent) {
+        return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+    }
+
+    std::string line;
+    int code = 0;
+    size_t length = 0;
+    if (_client->readLine(line, _timeoutMs) < 0 || sscanf(line.c_str(), "HTTP/1.%*d %d", &code) != 1) {
+        _client->stop();
+        return HTTPC_ERROR_READ_TIMEOUT;
+    }
+    while (_client->readLine(line, _timeoutMs) > 0) {
+        if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0) {
+            length = strtoul(line.c_str() + 15, NULL, 10);
+        } else if (strncasecmp(line.c_str(), "Connection: close", 17) == 0) {
+            _keepAlive = false;
+        }
+    }
+    if (!_client->readBytes(_body, length, _timeoutMs)) {
+        return HTTPC_ERROR_CONNECTION_LOST;
+    }
+    return code;
+}
+
+int HTTPClient::POST(uint8_t *payload, size_t size) {
+    uint64_t start = simHostMicros();
+    int code = request(payload, size);
+    uint32_t took = simHostMicros() - start;
+
+    std::lock_guard<std::mutex> guard(simStats.lock);
+    if (code > 0) {
+        simStats.posts++;
+        simStats.postUs.push_back(took);
+    } else {
+        simStats.postErrors++;
+    }
+    return code;
+}
+
+void HTTPClient::end() {
+    if (!_reuse || !_keepAlive) {
+        _client->stop();
+    }
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED:
+        return String("connection refused");
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED:
+        return String("send payload failed");
+    case HTTPC_ERROR_CONNECTION_LOST:
+        return String("connection lost");
+    case HTTPC_ERROR_READ_TIMEOUT:
+        return String("read Timeout");
+    default:
+        return String("unknown error");
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * Simulated station interface. begin() "joins" after a time modelled from
+ * simConfig.wifiConnectMs and the AP goes away on the simConfig drop
+ * schedule; events are delivered from a HAL thread like the core's event
+ * task.
+ */
+
+#ifndef WIFI_H
+#define WIFI_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL,
+    WL_SCAN_COMPLETED,
+    WL_CONNECTED,
+    WL_CONNECT_FAILED,
+    WL_CONNECTION_LOST,
+    WL_DISCONNECTED
+} wl_status_t;
+
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+
+typedef enum {
+    ARDUINO_EVENT_WIFI_STA_START,
+    ARDUINO_EVENT_WIFI_STA_CONNECTED,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP,
+    ARDUINO_EVENT_WIFI_STA_LOST_IP,
+    ARDUINO_EVENT_MAX
+} arduino_event_id_t;
+
+typedef arduino_event_id_t WiFiEvent_t;
+typedef void (*WiFiEventCb)(arduino_event_id_t event);
+
+class IPAddress {
+public:
+    IPAddress(uint32_t address = 0) : _address(address) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : _address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+    operator uint32_t() const { return _address; }
+    String toString() const;
+private:
+    uint32_t _address;
+};
+
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t mode) { return true; }
+    bool persistent(bool persistent) { return true; }
+    bool setAutoReconnect(bool autoReconnect) { return true; }
+    int onEvent(WiFiEventCb callback, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+
+    wl_status_t begin(const char *ssid, const char *password = NULL, int32_t channel = 0,
+                      const uint8_t *bssid = NULL, bool connect = true);
+    bool config(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns = IPAddress());
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    wl_status_t status();
+
+    IPAddress localIP();
+    IPAddress gatewayIP();
+    IPAddress subnetMask();
+    IPAddress dnsIP(uint8_t index = 0);
+    uint8_t *BSSID();
+    int32_t channel();
+};
+
+extern WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,26 @@
+// A real TCP socket; WiFi.h's link state does not gate it
+#ifndef WIFICLIENT_H
+#define WIFICLIENT_H
+
+#include <Arduino.h>
+
+class WiFiClient {
+public:
+    WiFiClient() : _fd(-1) {}
+    ~WiFiClient() { stop(); }
+
+    int connect(const char *host, uint16_t port, int timeoutMs);
+    bool connected() const { return _fd >= 0; }
+    void stop();
+    bool write(const void *data, size_t len);
+    int readLine(std::string &line, int timeoutMs);     // -1 on error
+    bool readBytes(std::string &out, size_t len, int timeoutMs);
+
+private:
+    int fill(int timeoutMs);
+
+    int _fd;
+    std::string _rx;
+};
+
+#endif
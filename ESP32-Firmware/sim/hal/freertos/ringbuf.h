@@ -0,0 +1,11 @@
+#ifndef FREERTOS_RINGBUF_H
+#define FREERTOS_RINGBUF_H
+
+#include <Arduino.h>
+
+typedef struct SimRingbuf *RingbufHandle_t;
+
+void *xRingbufferReceive(RingbufHandle_t ring, size_t *size, TickType_t wait);
+void vRingbufferReturnItem(RingbufHandle_t ring, void *item);
+
+#endif
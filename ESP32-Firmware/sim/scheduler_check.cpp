@@ -0,0 +1,166 @@
+/**
+ * Trace-driven check of the adaptive sampling cadence (lib/SampleScheduler).
+ *
+ * Replays a recorded plant trace through the scheduler with the hub's own
+ * settings: a reading is taken whenever the scheduler says it is due, from
+ * the trace row in effect at that time. Each change of interval is printed
+ * and checked against the scheduler's rules:
+ *
+ *   - the interval only ever doubles (capped at the max) after
+ *     STABLE_SAMPLES readings in a row at the same interval;
+ *   - otherwise it only drops, and only to the min, on a reading that moved;
+ *   - on drying.csv: back off to the max within the first 10 minutes of the
+ *     steady pot, drop to the min within one max interval of the watering
+ *     at 40 min, be back at the max 10 minutes after it, and stay there
+ *     through the sunny window from 80 min (warming slower than
+ *     TEMP_RATE_PER_MIN is not "moving").
+ *
+ *   cmake -S sim -B build-sim && cmake --build build-sim
+ *   build-sim/scheduler_check sim/traces/drying.csv [--verbose]
+ *
+ * Exits non-zero if any rule is broken.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <SampleScheduler.h>
+
+// As in src/temphumid.cpp
+const uint32_t MIN_SAMPLE_INTERVAL_MS = 2000;
+const uint32_t MAX_SAMPLE_INTERVAL_MS = 60000;
+const float TEMP_RATE_PER_MIN = 1.0;
+const float MOISTURE_RATE_PER_MIN = 200;
+const float TEMP_DEADBAND_C = 0.5;
+const int MOISTURE_DEADBAND = 50;
+const int STABLE_SAMPLES = 3;
+
+// drying.csv landmarks
+const uint32_t WATERED_AT_MS = 2400000;   // moisture steps up between two rows here
+const uint32_t SETTLE_MS = 600000;
+
+struct Row {
+    uint32_t ms;
+    float temp;
+    int moisture;
+};
+
+bool loadTrace(const char *path, std::vector<Row> &rows) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        Row row;
+        int humidity;
+        if (line[0] != '#' && sscanf(line, "%u,%f,%d,%d", &row.ms, &row.temp, &humidity, &row.moisture) == 4) {
+            rows.push_back(row);
+        }
+    }
+    fclose(file);
+    return !rows.empty();
+}
+
+int failures = 0;
+
+void expect(bool ok, const char *what, uint32_t now) {
+    if (!ok) {
+        printf("[Check] FAIL at %.1f min: %s\n", now / 60000.0, what);
+        failures++;
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *path = nullptr;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    std::vector<Row> rows;
+    if (!path || !loadTrace(path, rows)) {
+        fprintf(stderr, "usage: scheduler_check TRACE.csv [--verbose]\n");
+        return 2;
+    }
+    bool drying = strstr(path, "drying.csv") != nullptr;
+
+    SampleScheduler scheduler({MIN_SAMPLE_INTERVAL_MS, MAX_SAMPLE_INTERVAL_MS, TEMP_RATE_PER_MIN,
+                               MOISTURE_RATE_PER_MIN, TEMP_DEADBAND_C, MOISTURE_DEADBAND, STABLE_SAMPLES});
+
+    uint32_t end = rows.back().ms;
+    size_t row = 0;
+    int readings = 0;
+    int atInterval = 0;            // readings taken at the current interval
+    uint32_t firstMaxAt = 0;       // steady pot reached the max
+    uint32_t dropAt = 0;           // first drop to the min after watering
+    uint32_t backAt = 0;           // back at the max after that
+    float lastTemp = rows[0].temp;
+    int lastMoisture = rows[0].moisture;
+
+    for (uint32_t now = 0; now <= end; now += scheduler.waitMs(now)) {
+        while (row + 1 < rows.size() && rows[row + 1].ms <= now) {
+            row++;
+        }
+        const Row &sample = rows[row];
+
+        uint32_t before = scheduler.interval();
+        scheduler.record(now, sample.temp, sample.moisture);
+        uint32_t after = scheduler.interval();
+        readings++;
+        atInterval++;
+
+        if (after != before) {
+            if (verbose) {
+                printf("[Check] %6.1f min  %5u -> %5u ms  (T %.1f, M %d)\n", now / 60000.0, (unsigned)before,
+                       (unsigned)after, sample.temp, sample.moisture);
+            }
+            if (after > before) {
+                expect(after == (before * 2 < MAX_SAMPLE_INTERVAL_MS ? before * 2 : MAX_SAMPLE_INTERVAL_MS),
+                       "interval grew by other than doubling", now);
+                expect(atInterval >= STABLE_SAMPLES, "interval grew before STABLE_SAMPLES steady readings", now);
+            } else {
+                expect(after == MIN_SAMPLE_INTERVAL_MS, "interval dropped to other than the min", now);
+                bool moved = fabsf(sample.temp - lastTemp) > TEMP_DEADBAND_C ||
+                             abs(sample.moisture - lastMoisture) > MOISTURE_DEADBAND;
+                expect(moved, "interval dropped on a reading within the deadbands", now);
+            }
+            atInterval = 0;
+        }
+
+        if (after == MAX_SAMPLE_INTERVAL_MS && !firstMaxAt) {
+            firstMaxAt = now;
+        }
+        if (after == MIN_SAMPLE_INTERVAL_MS && now >= WATERED_AT_MS && !dropAt) {
+            dropAt = now;
+        }
+        if (drying && backAt) {
+            expect(after == MAX_SAMPLE_INTERVAL_MS, "slow drift sped sampling up again", now);
+        }
+        if (dropAt && after == MAX_SAMPLE_INTERVAL_MS && !backAt) {
+            backAt = now;
+        }
+        lastTemp = sample.temp;
+        lastMoisture = sample.moisture;
+    }
+
+    if (drying) {
+        expect(firstMaxAt && firstMaxAt <= SETTLE_MS, "steady pot never backed off to the max", firstMaxAt);
+        expect(dropAt && dropAt <= WATERED_AT_MS + MAX_SAMPLE_INTERVAL_MS + 15000,
+               "watering did not bring the interval down to the min", dropAt);
+        expect(backAt && backAt <= dropAt + SETTLE_MS, "interval did not back off again after watering", backAt);
+    }
+
+    printf("[Check] %d readings over %.0f min (%.1f/min); max after %.1f min, watered -> min at %.1f min, "
+           "back to max at %.1f min\n",
+           readings, end / 60000.0, readings / (end / 60000.0), firstMaxAt / 60000.0, dropAt / 60000.0,
+           backAt / 60000.0);
+    printf("[Check] %s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,280 @@
+/**
+ * Host build of the sensor hub (src/temphumid.cpp) with simulated
+ * peripherals, and an end-to-end benchmark.
+ *
+ * The firmware runs unchanged against hal/: a DHT11 and moisture probe fed
+ * from a trace, a scaled clock, simulated WiFi and a real HTTP client. Its
+ * uploads go to a stand-in /sensor/batch server on loopback (or --server).
+ * At the end it reports sampling rate, upload latency, loop jitter and the
+ * time one loop() pass takes. Every sensor pin reads the trace with its own
+ * offset, so a -DSENSOR_SHELF=ON build samples eight different plants.
+ *
+ *   cmake -S sim -B build-sim && cmake --build build-sim
+ *   build-sim/sensorhub_sim --duration 3600 --speed 100 --trace sim/traces/drying.csv --quiet
+ *
+ * Options:
+ *   --duration S         simulated seconds to run (300)
+ *   --speed X            simulated time per host time (1)
+ *   --trace FILE         CSV of ms,temp,humidity,moisture (default: synthetic plant)
+ *   --server HOST:PORT   post to a real server, e.g. the Flask app, instead of the stand-in
+ *   --server-delay MS    stand-in response time in host ms (0)
+ *   --drop-every S       drop WiFi every S simulated seconds (never)
+ *   --drop-for S         and keep the AP away this long (5)
+ *   --connect MS         full WiFi join time in simulated ms (3000)
+ *   --reset REASON       poweron, sw, wdt or brownout (poweron)
+ *   --dht-errors PCT     percent of DHT frames sent broken (0)
+ *   --uno TTY            Serial1 device for a -DUNO_LINK=1 build, e.g. the pty
+ *                        of ArduinoUno-Firmware/sim (keep --speed at 10 or less)
+ *   --uno-commands N     stop early once N commands went to the Uno and all are
+ *                        acked (the last window can take it a few past N)
+ *   --quiet              hide the firmware's Serial output
+ */
+
+#include <Arduino.h>
+#include <esp_system.h>
+#include <UnoLink.h>
+#include "hal/Sim.h"
+
+#include <algorithm>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+void setup();
+void loop();
+extern UnoLink unoLink;
+
+SimConfig simConfig = {1.0, NULL, "127.0.0.1", 0, false, ESP_RST_POWERON, 3000, 0, 5000, NULL, 0};
+SimStats simStats;
+
+static int standInDelayMs = 0;
+static std::mutex standInLock;
+static uint32_t standInRequests = 0;
+static uint32_t standInSamples = 0;
+static uint32_t standInSummaries = 0;
+
+// ---------------------------------------------------------------- stand-in server
+
+static bool readRequest(int fd, std::string &rx, std::string &body) {
+    size_t end;
+    while ((end = rx.find("\r\n\r\n")) == std::string::npos) {
+        char buf[2048];
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return false;
+        }
+        rx.append(buf, n);
+    }
+
+    size_t length = 0;
+    size_t at = rx.find("Content-Length:");
+    if (at != std::string::npos && at < end) {
+        length = strtoul(rx.c_str() + at + 15, NULL, 10);
+    }
+    rx.erase(0, end + 4);
+    while (rx.size() < length) {
+        char buf[2048];
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return false;
+        }
+        rx.append(buf, n);
+    }
+    body = rx.substr(0, length);
+    rx.erase(0, length);
+    return true;
+}
+
+// One keep-alive connection: answer every POST like app.py's /sensor/batch
+static void serveConnection(int fd) {
+    std::string rx, body;
+    while (readRequest(fd, rx, body)) {
+        // Same keys in JSON and CBOR; the summary, if any, comes last
+        size_t summary = body.find("summary");
+        uint32_t samples = 0;
+        for (size_t at = body.find("age_ms"); at < summary; at = body.find("age_ms", at + 1)) {
+            samples++;
+        }
+        {
+            std::lock_guard<std::mutex> guard(standInLock);
+            standInRequests++;
+            standInSamples += samples;
+            standInSummaries += summary != std::string::npos;
+        }
+        if (standInDelayMs) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(standInDelayMs));
+        }
+
+        std::string reply = "{\"status\":\"ok\",\"received\":" + std::to_string(samples) + ",\"sent\":true}";
+        std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                               std::to_string(reply.size()) + "\r\nConnection: keep-alive\r\n\r\n" + reply;
+        if (send(fd, response.data(), response.size(), MSG_NOSIGNAL) < 0) {
+            break;
+        }
+    }
+    close(fd);
+}
+
+static int startStandIn() {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (fd < 0 || bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 4) != 0 ||
+        getsockname(fd, (sockaddr *)&addr, &len) != 0) {
+        perror("[Sim] stand-in server");
+        exit(1);
+    }
+
+    std::thread([fd] {
+        for (;;) {
+            int client = accept(fd, NULL, NULL);
+            if (client >= 0) {
+                std::thread(serveConnection, client).detach();
+            }
+        }
+    }).detach();
+    return ntohs(addr.sin_port);
+}
+
+// ---------------------------------------------------------------- report
+
+static uint32_t percentile(std::vector<uint32_t> &values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    size_t i = std::min(values.size() - 1, (size_t)(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + i, values.end());
+    return values[i];
+}
+
+static void report(double simSeconds, double hostSeconds) {
+    std::lock_guard<std::mutex> guard(simStats.lock);
+    std::lock_guard<std::mutex> server(standInLock);
+
+    printf("\n[Sim] %.0f s simulated in %.1f s (x%.0f), trace: %s\n", simSeconds, hostSeconds, simConfig.speed,
+           simConfig.tracePath ? simConfig.tracePath : "synthetic");
+    printf("samples  read=%u (%.3f/s simulated) dht_faults=%u", simStats.reads, simStats.reads / simSeconds,
+           simStats.dhtFaults);
+    if (!simConfig.serverPort || standInRequests) {
+        printf("  uploaded=%u in %u requests (%.1f/s host), %u summaries", standInSamples, standInRequests,
+               standInSamples / hostSeconds, standInSummaries);
+    }
+    printf("\n");
+    printf("posts    ok=%u errors=%u  latency_us p50=%u p90=%u p99=%u max=%u\n", simStats.posts,
+           simStats.postErrors, percentile(simStats.postUs, 0.50), percentile(simStats.postUs, 0.90),
+           percentile(simStats.postUs, 0.99), percentile(simStats.postUs, 1.0));
+    printf("loop     wakeups=%u  overshoot_us p50=%u p99=%u max=%u  busy_us p50=%u p99=%u max=%u\n",
+           (unsigned)simStats.overshootUs.size(), percentile(simStats.overshootUs, 0.50),
+           percentile(simStats.overshootUs, 0.99), percentile(simStats.overshootUs, 1.0),
+           percentile(simStats.busyUs, 0.50), percentile(simStats.busyUs, 0.99), percentile(simStats.busyUs, 1.0));
+    printf("wifi     drops=%u\n", simStats.drops);
+    if (UNO_LINK) {
+        const UnoLinkStats &uno = unoLink.stats();
+        printf("uno      sent=%u acked=%u resent=%u naks=%u timeouts=%u dropped=%u resyncs=%u next_seq=%u\n",
+               (unsigned)uno.sent, (unsigned)uno.acked, (unsigned)uno.resent, (unsigned)uno.naks,
+               (unsigned)uno.timeouts, (unsigned)uno.dropped, (unsigned)uno.resyncs, (unsigned)unoLink.nextSeq());
+    }
+}
+
+// ---------------------------------------------------------------- main
+
+static void usage() {
+    fprintf(stderr, "usage: sensorhub_sim [--duration S] [--speed X] [--trace FILE] [--server HOST:PORT]\n"
+                    "                     [--server-delay MS] [--drop-every S] [--drop-for S] [--connect MS]\n"
+                    "                     [--reset poweron|sw|wdt|brownout] [--dht-errors PCT] [--uno TTY]\n"
+                    "                     [--uno-commands N] [--quiet]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    double duration = 300;
+    uint32_t unoCommands = 0;
+    static std::string serverHost;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (arg == "--quiet") {
+            simConfig.quiet = true;
+            continue;
+        }
+        if (!value) {
+            usage();
+        }
+        i++;
+
+        if (arg == "--duration") {
+            duration = atof(value);
+        } else if (arg == "--speed") {
+            simConfig.speed = atof(value);
+        } else if (arg == "--trace") {
+            simConfig.tracePath = value;
+        } else if (arg == "--server") {
+            const char *colon = strrchr(value, ':');
+            if (!colon) {
+                usage();
+            }
+            serverHost.assign(value, colon - value);
+            simConfig.serverHost = serverHost.c_str();
+            simConfig.serverPort = atoi(colon + 1);
+        } else if (arg == "--server-delay") {
+            standInDelayMs = atoi(value);
+        } else if (arg == "--drop-every") {
+            simConfig.wifiDropEveryMs = atof(value) * 1000;
+        } else if (arg == "--drop-for") {
+            simConfig.wifiDropMs = atof(value) * 1000;
+        } else if (arg == "--connect") {
+            simConfig.wifiConnectMs = atoi(value);
+        } else if (arg == "--dht-errors") {
+            simConfig.dhtErrorRate = atof(value) / 100;
+        } else if (arg == "--uno") {
+            simConfig.unoPath = value;
+        } else if (arg == "--uno-commands") {
+            unoCommands = atoi(value);
+        } else if (arg == "--reset") {
+            std::string reason = value;
+            simConfig.resetReason = reason == "poweron"    ? ESP_RST_POWERON
+                                    : reason == "sw"       ? ESP_RST_SW
+                                    : reason == "wdt"      ? ESP_RST_TASK_WDT
+                                    : reason == "brownout" ? ESP_RST_BROWNOUT
+                                                           : -1;
+            if (simConfig.resetReason < 0) {
+                usage();
+            }
+        } else {
+            usage();
+        }
+    }
+    if (simConfig.speed <= 0 || duration <= 0) {
+        usage();
+    }
+
+    if (!simConfig.serverPort) {
+        simConfig.serverPort = startStandIn();
+    }
+    if (simConfig.tracePath) {
+        fprintf(stderr, "[Sim] %u trace rows\n", simTraceRows());
+    }
+
+    simStartClock();
+    simStartWiFi();
+    setup();
+    while (millis() < duration * 1000) {
+        loop();
+
+        // A fixed amount of work for the Uno, however fast the host is
+        const UnoLinkStats &uno = unoLink.stats();
+        if (UNO_LINK && unoCommands && uno.sent >= unoCommands && uno.acked >= uno.sent) {
+            break;
+        }
+    }
+
+    report(millis() / 1000.0, simHostMicros() / 1e6);
+    fflush(stdout);
+    _exit(0);  // The upload and WiFi tasks never return
+}
@@ -0,0 +1,84 @@
+"""
+Sim scenario: the hub restarts while the Uno keeps running.
+
+Starts the Uno host build (ArduinoUno-Firmware/sim, lcd_sim) once and runs
+a -DUNO_LINK=ON sensorhub_sim against it twice, as a hub reset would. The
+second run starts again at seq 0 while the Uno still expects the first
+run's next seq, at most 16 on: without a resync the Uno takes the new
+commands for repeats of its last ones, re-acks them and draws nothing.
+Each run stops after a set number of commands (--uno-commands), the
+second well short of the first, so a Uno that skipped them is still on
+the first run's seq at the end; the scenario passes if it expects exactly
+the seq the hub would send next and nothing was dropped.
+
+    python3 sim/uno_restart.py --lcd-sim ../ArduinoUno-Firmware/build-sim/lcd_sim \\
+        --hub-sim build-sim/sensorhub_sim
+
+ctest runs it when the sim is configured with -DUNO_LINK=ON -DLCD_SIM=<path>.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+
+# Simulated seconds a run may take to get its commands through; one sensor
+# sends on change, a command every 20 s or so
+RUN_LIMIT = 600
+
+
+def run_hub(hub_sim: str, tty: str, trace: str, commands: int) -> dict:
+    out = subprocess.run([hub_sim, "--duration", str(RUN_LIMIT), "--speed", "10", "--uno", tty,
+                          "--uno-commands", str(commands), "--trace", trace, "--quiet"],
+                         capture_output=True, text=True, timeout=RUN_LIMIT + 60).stdout
+    match = re.search(r"^uno +(.*)$", out, re.MULTILINE)
+    if not match:
+        sys.exit(f"[Restart] no Uno report from the hub:\n{out}")
+    return {k: int(v) for k, v in re.findall(r"(\w+)=(\d+)", match.group(1))}
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--lcd-sim", required=True)
+    parser.add_argument("--hub-sim", required=True)
+    parser.add_argument("--trace", default=os.path.join(here, "traces", "drying.csv"))
+    parser.add_argument("--first", type=int, default=8, help="commands before the reset")
+    parser.add_argument("--second", type=int, default=3, help="commands after it")
+    args = parser.parse_args()
+
+    tty = os.path.join(tempfile.mkdtemp(), "uno-tty")
+    lcd = subprocess.Popen([args.lcd_sim, "--link", tty], stderr=subprocess.PIPE, text=True)
+    try:
+        for _ in range(50):
+            if os.path.exists(tty):
+                break
+            time.sleep(0.1)
+
+        first = run_hub(args.hub_sim, tty, args.trace, args.first)
+        print(f"[Restart] first run:  {first}")
+        second = run_hub(args.hub_sim, tty, args.trace, args.second)
+        print(f"[Restart] second run: {second}")
+        time.sleep(1)  # the Uno drains what the hub wrote last
+    finally:
+        lcd.terminate()
+        uno_report = lcd.communicate(timeout=10)[1]
+
+    match = re.search(r"next_seq=(\d+)", uno_report)
+    uno_next = int(match.group(1)) if match else None
+    print(f"[Restart] Uno expects #{uno_next}, hub would send #{second['next_seq']}")
+
+    if not 0 < second["sent"] < first["sent"] <= 16:
+        sys.exit("[Restart] inconclusive: need 0 < second run < first run <= 16 commands, "
+                 "adjust --first/--second")
+    ok = uno_next == second["next_seq"] and second["dropped"] == 0
+    print("[Restart] OK" if ok else "[Restart] FAILED: the Uno did not follow the restarted hub")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,86 @@
+/**
+ * Host benchmark for the moisture ADC filter (lib/AdcFilter).
+ *
+ * Feeds a slowly drying probe with ESP32-like ADC noise (a few dozen counts
+ * on every read, a 2 % chance of a spike of a few hundred) through the
+ * filter at several burst sizes and EMA weights, and prints the time per
+ * raw reading and how far the output strays from the true value. Builds
+ * for the PC, not the board:
+ *
+ *   pio run -e native_adc_bench && .pio/build/native_adc_bench/program
+ *
+ * Cycles are the host's time-stamp counter (x86 only), a rough guide to the
+ * ESP32 cost.
+ */
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <AdcFilter.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+const int SAMPLES = 20000;
+
+std::mt19937 rng(1);
+
+uint16_t noisy(double truth) {
+    int counts = (int)lround(truth + std::normal_distribution<double>(0, 20)(rng));
+    if (std::uniform_int_distribution<int>(0, 99)(rng) < 2) {
+        counts += std::uniform_int_distribution<int>(-400, 400)(rng);
+    }
+    return counts < 0 ? 0 : counts > 4095 ? 4095 : counts;
+}
+
+// A probe at 2600 counts drying by 1 count every 20 samples
+double truthAt(int sample) {
+    return 2600 - sample * 0.05;
+}
+
+void bench(uint8_t burst, uint8_t emaShift) {
+    static uint16_t raw[SAMPLES][ADC_FILTER_MAX_BURST];
+    for (int i = 0; i < SAMPLES; i++) {
+        for (int j = 0; j < burst; j++) {
+            raw[i][j] = noisy(truthAt(i));
+        }
+    }
+
+    AdcFilter filter({burst, emaShift});
+    double squared = 0;
+    int worst = 0;
+    auto start = std::chrono::steady_clock::now();
+#ifdef HAVE_TSC
+    uint64_t cycles = __rdtsc();
+#endif
+    for (int i = 0; i < SAMPLES; i++) {
+        int value = filter.add(raw[i], burst);
+        int error = value - (int)lround(truthAt(i));
+        squared += (double)error * error;
+        worst = error < 0 ? (-error > worst ? -error : worst) : (error > worst ? error : worst);
+    }
+#ifdef HAVE_TSC
+    cycles = __rdtsc() - cycles;
+#endif
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    printf("burst %2u  ema 1/%-2u  %6.1f ns/read", burst, 1u << emaShift, ns / SAMPLES / burst);
+#ifdef HAVE_TSC
+    printf("  %6.1f cycles/read", (double)cycles / SAMPLES / burst);
+#endif
+    printf("  error rms %5.1f max %4d counts\n", sqrt(squared / SAMPLES), worst);
+}
+
+int main() {
+    printf("%d samples, truth drifting 0.05 counts/sample\n", SAMPLES);
+    bench(1, 0);   // a single analogRead(), the old behaviour
+    bench(1, 2);
+    bench(5, 0);
+    bench(15, 0);
+    bench(15, 2);  // MOISTURE_BURST, MOISTURE_EMA_SHIFT in temphumid.cpp
+    bench(31, 2);
+    bench(15, 4);
+    return 0;
+}
@@ -0,0 +1,170 @@
+/**
+ * Host check and benchmark for the DHT frame decoder (lib/DhtDecoder).
+ *
+ * Decodes synthetic frames, clean, jittered and broken in the ways a long
+ * sensor wire breaks them, checks each gets the expected status and value,
+ * and times the decoder. Builds for the PC, not the board:
+ *
+ *   pio run -e native_dht_bench && .pio/build/native_dht_bench/program [capture.csv ...]
+ *
+ * A capture file holds recorded frames as `level,us` lines (e.g. dumped
+ * from the RMT items on the board), frames separated by a blank line; each
+ * one is decoded and printed. Exits non-zero if any synthetic case fails.
+ */
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <DhtDecoder.h>
+
+const int FRAMES = 2000;           // per case
+const int ROUNDS = 200;            // timing passes over the clean frames
+
+std::mt19937 rng(1);
+
+int randomInt(int min, int max) {
+    return std::uniform_int_distribution<int>(min, max)(rng);
+}
+
+// A reading the sensor can represent in its 0.1 steps
+void randomReading(DhtModel model, float *temp, float *humidity) {
+    *temp = randomInt(model == DHT_MODEL_11 ? 0 : -400, 500) / 10.0f;
+    *humidity = randomInt(200, 950) / 10.0f;
+}
+
+size_t makeFrame(DhtModel model, float temp, float humidity, DhtSpan *spans) {
+    uint8_t data[5];
+    dhtPack(model, temp, humidity, data);
+    return dhtSynthesize(data, spans, DHT_FRAME_SPANS);
+}
+
+enum Fault { NONE, JITTER, FLIP, TRUNCATE, SILENT, GLITCH };
+
+// Returns the status the decoder should report for the damaged frame
+DhtStatus damage(Fault fault, DhtSpan *spans, size_t *count) {
+    switch (fault) {
+        case JITTER:
+            for (size_t i = 0; i < *count; i++) {
+                spans[i].us += randomInt(-15, 15);
+            }
+            return DHT_OK;
+        case FLIP: {
+            DhtSpan &high = spans[4 + 2 * randomInt(0, 39)];
+            high.us = high.us > DHT_BIT_ONE_US ? 27 : 70;
+            return DHT_CHECKSUM;
+        }
+        case TRUNCATE:
+            *count = 3 + 2 * randomInt(0, 39);
+            return DHT_TIMEOUT;
+        case SILENT:
+            // Just the pulled-up line, the way the RMT sees a missing sensor
+            *count = 1;
+            spans[0].us = 12000;
+            return DHT_NO_RESPONSE;
+        case GLITCH:
+            spans[3 + randomInt(0, 79)].us = 150;
+            return DHT_BAD_PULSE;
+        default:
+            return DHT_OK;
+    }
+}
+
+bool runCase(const char *name, DhtModel model, Fault fault) {
+    int failures = 0;
+    for (int i = 0; i < FRAMES; i++) {
+        float temp, humidity;
+        randomReading(model, &temp, &humidity);
+        DhtSpan spans[DHT_FRAME_SPANS];
+        size_t count = makeFrame(model, temp, humidity, spans);
+        DhtStatus expected = damage(fault, spans, &count);
+
+        DhtReading reading;
+        DhtStatus status = dhtDecode(spans, count, model, &reading);
+        bool ok = status == expected;
+        if (ok && status == DHT_OK) {
+            ok = fabsf(reading.temperature - temp) < 0.05f && fabsf(reading.humidity - humidity) < 0.05f;
+        }
+        if (!ok && failures++ == 0) {
+            printf("  %s: %.1f C %.1f %% decoded as %s (%.1f C %.1f %%), expected %s\n", name, temp, humidity,
+                   dhtStatusString(status), status == DHT_OK ? reading.temperature : 0.0f,
+                   status == DHT_OK ? reading.humidity : 0.0f, dhtStatusString(expected));
+        }
+    }
+    printf("%-14s %5d frames  %s\n", name, FRAMES, failures ? "FAIL" : "ok");
+    return failures == 0;
+}
+
+void bench() {
+    static DhtSpan frames[FRAMES][DHT_FRAME_SPANS];
+    for (int i = 0; i < FRAMES; i++) {
+        float temp, humidity;
+        randomReading(DHT_MODEL_11, &temp, &humidity);
+        makeFrame(DHT_MODEL_11, temp, humidity, frames[i]);
+    }
+
+    volatile float sink = 0;  // keep the decoder from being optimized away
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < FRAMES; i++) {
+            DhtReading reading;
+            if (dhtDecode(frames[i], DHT_FRAME_SPANS, DHT_MODEL_11, &reading) == DHT_OK) {
+                sink = sink + reading.temperature;
+            }
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    printf("decode         %7.1f ns/frame\n", ns / ROUNDS / FRAMES);
+}
+
+void decodeCapture(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        printf("%s: cannot open\n", path);
+        return;
+    }
+
+    DhtSpan spans[256];
+    size_t count = 0;
+    int frame = 0;
+    char line[64];
+    bool more = true;
+    while (more) {
+        more = fgets(line, sizeof(line), file) != NULL;
+        unsigned level, us;
+        if (more && sscanf(line, "%u,%u", &level, &us) == 2) {
+            if (count < sizeof(spans) / sizeof(spans[0])) {
+                spans[count++] = {(uint16_t)us, (uint8_t)(level ? 1 : 0)};
+            }
+            continue;
+        }
+        if (count && (!more || line[0] == '\n' || line[0] == '\r')) {
+            DhtReading reading;
+            DhtStatus status = dhtDecode(spans, count, DHT_MODEL_11, &reading);
+            printf("%s #%d: %3u spans  %s", path, frame++, (unsigned)count, dhtStatusString(status));
+            if (status == DHT_OK) {
+                printf("  %.1f C %.0f %%", reading.temperature, reading.humidity);
+            }
+            printf("\n");
+            count = 0;
+        }
+    }
+    fclose(file);
+}
+
+int main(int argc, char **argv) {
+    bool ok = true;
+    ok = runCase("dht11 clean", DHT_MODEL_11, NONE) && ok;
+    ok = runCase("dht22 clean", DHT_MODEL_22, NONE) && ok;
+    ok = runCase("jitter 15us", DHT_MODEL_11, JITTER) && ok;
+    ok = runCase("flipped bit", DHT_MODEL_11, FLIP) && ok;
+    ok = runCase("cut short", DHT_MODEL_11, TRUNCATE) && ok;
+    ok = runCase("no sensor", DHT_MODEL_11, SILENT) && ok;
+    ok = runCase("glitch", DHT_MODEL_11, GLITCH) && ok;
+    bench();
+
+    for (int i = 1; i < argc; i++) {
+        decodeCapture(argv[i]);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+/**
+ * Host benchmark for the /sensor/batch payload encoder.
+ *
+ * Encodes the same batches as JSON and as CBOR with lib/PayloadWriter and
+ * prints bytes and encode time per sample for each format. Builds for the
+ * PC, not the board:
+ *
+ *   pio run -e native_bench && .pio/build/native_bench/program
+ *
+ * Batches mix full samples (first report, heartbeat) with the one- or
+ * two-field samples that change-only reporting mostly sends.
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <SampleRing.h>
+#include <PayloadWriter.h>
+
+const int BATCH = 30;              // BATCH_MAX in temphumid.cpp
+const int ROUNDS = 20000;
+
+uint8_t payloadBuf[PAYLOAD_SIZE(BATCH)];
+
+void makeBatch(Sample *samples) {
+    for (int i = 0; i < BATCH; i++) {
+        samples[i].temp = 21.5f + (i % 7) * 0.3f;
+        samples[i].humidity = 40 + i % 9;
+        samples[i].moisture = 1800 + i * 13;
+        samples[i].moisturePct = -1;  // MOISTURE_CALIBRATED off
+        samples[i].channel = 0;
+        samples[i].takenAt = i * 2000;
+        // Every 10th sample is a heartbeat, the rest carry what moved
+        samples[i].fields = i % 10 == 0 ? SAMPLE_ALL : (i % 3 == 0 ? SAMPLE_TEMP | SAMPLE_MOIST : SAMPLE_MOIST);
+    }
+}
+
+void bench(const char *name, PayloadFormat format, const Sample *samples) {
+    size_t length = 0;
+    volatile uint8_t sink = 0;  // keep the encoder from being optimized away
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        PayloadWriter payload(payloadBuf, sizeof(payloadBuf), format);
+        payload.begin(BATCH);
+        for (int i = 0; i < BATCH; i++) {
+            payload.add(samples[i], BATCH * 2000 - samples[i].takenAt);
+        }
+        length = payload.finish();
+        sink = sink + payloadBuf[length / 2];
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%-5s %5u bytes/batch  %6.1f bytes/sample  %7.1f ns/sample\n", name, (unsigned)length,
+           (double)length / BATCH, ns / ROUNDS / BATCH);
+}
+
+int main() {
+    Sample samples[BATCH];
+    makeBatch(samples);
+
+    printf("%d samples per batch, %d rounds\n", BATCH, ROUNDS);
+    bench("json", PAYLOAD_JSON, samples);
+    bench("cbor", PAYLOAD_CBOR, samples);
+    return 0;
+}
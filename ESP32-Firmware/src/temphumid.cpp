@@ -1,17 +1,44 @@
 /**
  * ESP32 Sensor Hub - Sends sensor data to PC server via HTTP
  * 
- * Sensors:
- * - DHT11 (temperature + humidity) on GPIO 16
- * - Moisture sensor on GPIO 15
+ * Sensors are rows of the SENSORS table: a DHT11 (temperature + humidity)
+ * or a moisture probe, its pin, and the channel (plant) its readings belong
+ * to. By default one plant: the DHT11 on GPIO 15 and a probe on GPIO 16;
+ * -DSENSOR_SHELF=1 builds an eight-plant shelf instead.
  * 
- * Sends JSON to: http://<SERVER_IP>:5000/sensor
+ * Sends JSON (or CBOR) batches to: http://<SERVER_IP>:5000/sensor/batch
+ *
+ * loop() (core 1) only samples and queues; the upload task (core 0) owns
+ * WiFi and HTTP, so a slow server never delays a sensor read. With
+ * -DUNO_LINK=1 a third task drives the Uno LCD directly over Serial1.
  */
 
 #include <Arduino.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <time.h>
+#include <Preferences.h>
 #include <WiFi.h>
 #include <HTTPClient.h>
-#include <DHTesp.h>
+#include <driver/gpio.h>
+#include <driver/rmt.h>
+#include <DhtDecoder.h>
+#include <AdcFilter.h>
+#include <RollingStats.h>
+#include <SampleRing.h>
+#include <SampleScheduler.h>
+#include <PayloadWriter.h>
+#include <UnoLink.h>
+
+#ifndef UNO_LINK
+#define UNO_LINK 0       // 1: drive the Uno LCD directly over Serial1
+#endif
+#ifndef SERVER_UPLOAD
+#define SERVER_UPLOAD 1  // 0: no WiFi, no server (needs UNO_LINK)
+#endif
+#ifndef SENSOR_SHELF
+#define SENSOR_SHELF 0   // 1: the eight-plant sensor table below
+#endif
 
 // ============== CONFIGURATION ==============
 // WiFi credentials - UPDATE THESE
@@ -19,140 +46,1134 @@ const char* WIFI_SSID = "Sharisse";
 const char* WIFI_PASSWORD = "panictime";
 
 // Server URL - UPDATE with your PC's IP address
-const char* SERVER_URL = "http://172.20.10.3:5000/sensor";
+const char* SERVER_URL = "http://172.20.10.3:5000/sensor/batch";
+
+// Sensors, one row each. A plant's DHT11 and probe share a channel;
+// intervalMs 0 samples adaptively (see below), otherwise at that fixed rate.
+enum SensorType {
+    SENSOR_DHT11,     // temperature + humidity
+    SENSOR_MOISTURE   // capacitive probe on an ADC pin
+};
+
+struct SensorConfig {
+    SensorType type;
+    int pin;
+    uint8_t channel;           // below CHANNEL_MAX
+    unsigned long intervalMs;
+};
+
+#if SENSOR_SHELF
+// A probe in each of eight pots on ADC1 (ADC2 is WiFi's), a DHT11 per three
+const SensorConfig SENSORS[] = {
+    {SENSOR_DHT11, 15, 0, 0},
+    {SENSOR_DHT11, 21, 3, 0},
+    {SENSOR_DHT11, 47, 6, 0},
+    {SENSOR_MOISTURE, 1, 0, 0},
+    {SENSOR_MOISTURE, 2, 1, 0},
+    {SENSOR_MOISTURE, 3, 2, 0},
+    {SENSOR_MOISTURE, 4, 3, 0},
+    {SENSOR_MOISTURE, 5, 4, 0},
+    {SENSOR_MOISTURE, 6, 5, 0},
+    {SENSOR_MOISTURE, 7, 6, 0},
+    {SENSOR_MOISTURE, 8, 7, 0},
+};
+#else
+const SensorConfig SENSORS[] = {
+    {SENSOR_DHT11, 15, 0, 0},
+    {SENSOR_MOISTURE, 16, 0, 0},
+};
+#endif
+const int SENSOR_COUNT = sizeof(SENSORS) / sizeof(SENSORS[0]);
+const int CHANNEL_MAX = 16;
 
-// Sensor pins
-const int DHT_PIN = 15;
-const int MOISTURE_PIN = 16;
+// Sensor scheduling
+const unsigned long DHT_MIN_INTERVAL_MS = 2000;  // Per DHT11, which answers at most once a second
+const unsigned long SENSOR_STAGGER_MS = 250;     // Between the sensors' first reads
+const int MOISTURE_BURSTS_PER_PASS = 2;          // Probe bursts per loop() pass, ~225 us each
 
 // Timing
-const unsigned long SEND_INTERVAL_MS = 2000;  // Send every 2 seconds
-const int WIFI_RETRY_DELAY_MS = 500;
-const int MAX_WIFI_RETRIES = 20;
+const unsigned long RETRY_DELAY_MS = 2000;      // After a failed upload
 const int HTTP_TIMEOUT_MS = 5000;
+const unsigned long STATS_INTERVAL_MS = 30000;  // Print upload counters
+
+// WiFi reconnects
+const unsigned long WIFI_ATTEMPT_TIMEOUT_MS = 10000;  // Give up on one attempt
+const unsigned long WIFI_BACKOFF_MIN_MS = 500;        // Between failed attempts,
+const unsigned long WIFI_BACKOFF_MAX_MS = 30000;      // doubling up to this, +-50% jitter
+const unsigned long WIFI_POLL_MS = 50;                // State machine tick while down
+const bool FAST_BOOT_STATIC_IP = true;                // Reuse the last lease, skip DHCP
+const long STATIC_IP_MAX_AGE_S = 3600;                // Shortest lease we expect from the AP
+
+// Boot
+const unsigned long DHT_POWER_UP_MS = 1000;  // DHT11 settle time, only after power-on
+
+// DHT11 capture
+const unsigned long DHT_START_MS = 20;        // Start pulse, the DHT11 needs 18 ms
+const unsigned long DHT_FRAME_TIMEOUT_MS = 10;  // A frame takes ~5 ms
+const uint16_t DHT_IDLE_US = 200;             // Line high this long: frame over
+const rmt_channel_t DHT_RMT_CHANNEL = RMT_CHANNEL_4;  // RX channels are 4-7 on the S3
+
+// Moisture ADC
+const int MOISTURE_BURST = 15;               // Reads per sample, ~15 us each; the median is kept
+const int MOISTURE_EMA_SHIFT = 2;            // Newest sample weighs 1/4
+const bool MOISTURE_CALIBRATED = false;      // Also report moisture_pct
+const uint16_t MOISTURE_DRY = 800;           // Default endpoints until "cal dry"/"cal wet"
+const uint16_t MOISTURE_WET = 2800;
+
+// Edge statistics
+const int STATS_WINDOW = 30;                 // Samples the rolling figures cover
+const unsigned long SUMMARY_INTERVAL_MS = 60000;  // Send a summary this often
+const int DRY_THRESHOLD = 1000;              // Moisture the Uno calls BAD; dry_in_h counts down to it
+const bool UPLOAD_SAMPLES = true;            // false: upload summaries only
+
+// Upload task
+const int UPLOAD_CORE = 0;          // loop() runs on core 1
+const int UPLOAD_STACK_SIZE = 8192;
+const int SAMPLE_QUEUE_LEN = 8;     // Samples handed over, not yet buffered
+
+// Change-only reporting: only fields that moved past their deadband, plus
+// every field after HEARTBEAT_MS of silence, so a steady plant costs almost
+// no requests, serial writes or LCD redraws
+const float TEMP_DEADBAND_C = 0.5;
+const float HUMIDITY_DEADBAND = 2;           // %RH
+const int MOISTURE_DEADBAND = 50;            // ADC counts
+const unsigned long HEARTBEAT_MS = 60000;    // Report every field at least this often
+
+// Adaptive sampling: every MIN_SAMPLE_INTERVAL_MS while temperature or
+// moisture is moving, doubling up to MAX_SAMPLE_INTERVAL_MS while they are
+// steady. Changes within the deadbands above never speed it up.
+const unsigned long MIN_SAMPLE_INTERVAL_MS = 2000;   // While readings are moving
+const unsigned long MAX_SAMPLE_INTERVAL_MS = 60000;  // Cap while they are steady
+const float TEMP_RATE_PER_MIN = 1.0;         // Faster than this counts as moving
+const float MOISTURE_RATE_PER_MIN = 200;     // ADC counts
+const int STABLE_SAMPLES = 3;                // Steady readings before the interval doubles
+
+// Direct Uno link (UNO_LINK). Uno TX is 5 V: use a divider into UNO_RX_PIN.
+const int UNO_RX_PIN = 17;
+const int UNO_TX_PIN = 18;
+const unsigned long UNO_BAUD = 115200;
+const int UNO_WINDOW = 4;                    // 4 tagged commands fit the Uno's 63-byte RX buffer
+const unsigned long UNO_ACK_TIMEOUT_MS = 500;
+const unsigned long UNO_POLL_MS = 5;         // Reply polling while commands are in flight
+const int UNO_STACK_SIZE = 4096;
+
+// Batching
+const int BATCH_SIZE = 5;           // Post once this many samples are buffered
+const int BATCH_MAX = 30;           // Most samples in one request
+const unsigned long BATCH_MAX_WAIT_MS = 10000;  // or once the oldest is this old
+const PayloadFormat UPLOAD_FORMAT = PAYLOAD_JSON;  // PAYLOAD_CBOR is ~30% smaller
 // ===========================================
 
-DHTesp dht;
-unsigned long lastSendTime = 0;
+// Upload counters; each one is only written by one task
+struct UploadStats {
+    volatile uint32_t sent;          // samples the server took
+    volatile uint32_t batches;
+    volatile uint32_t failed;        // requests
+    volatile uint32_t dropped;       // queue full, oldest sample discarded
+    volatile uint32_t overwritten;   // ring full during an outage
+    volatile uint32_t lastLatencyMs;
+    volatile uint32_t maxLatencyMs;
+    volatile uint32_t totalLatencyMs;
+};
 
-void connectWiFi() {
-    Serial.print("[WiFi] Connecting to ");
-    Serial.println(WIFI_SSID);
-    
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+// WiFi state, only changed by wifiTick() in the upload task
+enum WifiState {
+    LINK_DOWN,        // waiting for the next attempt
+    LINK_CONNECTING,
+    LINK_UP
+};
+
+// Reconnect counters, written by the upload task
+struct WifiStats {
+    volatile uint32_t attempts;
+    volatile uint32_t connects;
+    volatile uint32_t drops;
+    volatile uint32_t lastReconnectMs;  // from losing the link to having an IP
+    volatile uint32_t maxReconnectMs;
+    volatile uint32_t totalReconnectMs;
+};
+
+// Access point and lease of the last connection, for a reconnect without
+// a scan or DHCP. Kept in RTC memory and mirrored to NVS for power-on boots.
+struct ApCache {
+    uint32_t magic;
+    uint8_t bssid[6];
+    int32_t channel;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    int64_t leasedAt;    // time() of the DHCP result; RTC time runs on over soft resets
+};
+
+const uint32_t AP_CACHE_MAGIC = 0x41504303;  // "APC" + version, bump when ApCache changes
+
+// DHT read in progress, only used by loop()
+enum DhtPhase {
+    DHT_IDLE,
+    DHT_START,      // holding the line low
+    DHT_CAPTURE     // line released, RMT recording
+};
+
+const size_t DHT_CAPTURE_SPANS = DHT_FRAME_SPANS + 16;  // room for noise before the response
+
+// One sensor's schedule and filter, only used by loop()
+struct SensorState {
+    SampleScheduler scheduler;
+    AdcFilter filter;               // moisture probes
+    MoistureCalibration cal;        // moisture probes
+    unsigned long lastReportTime;   // for the heartbeat
+    bool reportedOnce;
+    uint32_t errors;
+
+    SensorState(const SchedulerConfig &config)
+        : scheduler(config), filter({MOISTURE_BURST, MOISTURE_EMA_SHIFT}), cal({MOISTURE_DRY, MOISTURE_WET}),
+          lastReportTime(0), reportedOnce(false), errors(0) {
+    }
+};
+
+// One plant's reported values and rolling statistics, only used by loop()
+struct ChannelState {
+    Sample lastReported;            // for the deadbands
+    RollingStats temp;              // tenths of a degree
+    RollingStats humidity;
+    RollingStats moisture;
+    unsigned long nextSummaryAt;
+
+    ChannelState() : lastReported(), temp(STATS_WINDOW), humidity(STATS_WINDOW), moisture(STATS_WINDOW),
+                     nextSummaryAt(0) {
+    }
+};
+
+SensorState *sensors[SENSOR_COUNT];   // Created in setup(), like channels
+ChannelState *channels[CHANNEL_MAX];  // NULL for channels without sensors
+int dhtCursor = -1;                   // Last sensor read, for the turns
+int moistureCursor = -1;
+char consoleLine[16];
+uint8_t consoleLength = 0;
+
+DhtPhase dhtPhase = DHT_IDLE;
+unsigned long dhtPhaseStart = 0;
+int dhtSensor = -1;                   // SENSORS index being read
+int dhtPin = -1;                      // where the RMT receiver listens
+RingbufHandle_t dhtRing = NULL;
+DhtSpan dhtSpans[DHT_CAPTURE_SPANS];
+QueueHandle_t sampleQueue;
+QueueHandle_t summaryQueue;
+UploadStats uploadStats;
+unsigned long lastStatsTime = 0;
+bool bootReported = false;
+uint32_t samplesUnchanged = 0;
+
+// Samples not yet accepted by the server, in RTC memory so a soft reset
+// keeps them. Only used by the upload task.
+RTC_NOINIT_ATTR SampleRing sampleRing;
+
+// Written by the WiFi event task, read by wifiTick()
+volatile bool wifiLinkUp = false;
+volatile uint32_t wifiDisconnectEvents = 0;
+
+WifiState wifiState = LINK_DOWN;
+WifiStats wifiStats;
+RTC_NOINIT_ATTR ApCache apCache;
+Preferences prefs;
+bool useApCache = true;                // cleared when a cached attempt fails
+bool staticIpTried = false;            // the cached lease is only reused once per boot
+bool wifiStaticIp = false;             // the current attempt skipped DHCP
+unsigned long wifiDownSince = 0;
+unsigned long wifiNextAttempt = 0;
+unsigned long wifiAttemptStart = 0;
+unsigned long wifiBackoffMs = WIFI_BACKOFF_MIN_MS;
+uint32_t wifiDisconnectsAtStart = 0;
+
+// Direct Uno link; the link itself is only used by the Uno task
+void writeToUno(const char *data, size_t len);
+QueueHandle_t unoQueue;
+UnoLink unoLink(writeToUno, UNO_WINDOW, UNO_ACK_TIMEOUT_MS);
+
+// Only used by the upload task. The client stays connected between
+// requests, so each POST skips the TCP handshake.
+WiFiClient uploadClient;
+HTTPClient http;
+uint8_t payloadBuf[PAYLOAD_SIZE(BATCH_MAX)];
+
+// Runs on the WiFi event task: only record what happened
+void onWiFiEvent(WiFiEvent_t event) {
+    switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+        wifiLinkUp = true;
+        break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+        wifiDisconnectEvents++;
+        wifiLinkUp = false;
+        break;
+    case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+        wifiLinkUp = false;
+        break;
+    default:
+        break;
+    }
+}
+
+void startWiFiAttempt(unsigned long now) {
+    wifiStats.attempts++;
+    wifiAttemptStart = now;
+    wifiDisconnectsAtStart = wifiDisconnectEvents;
+    wifiState = LINK_CONNECTING;
     
-    int retries = 0;
-    while (WiFi.status() != WL_CONNECTED && retries < MAX_WIFI_RETRIES) {
-        delay(WIFI_RETRY_DELAY_MS);
-        Serial.print(".");
-        retries++;
+    // Fast boot: the first attempt after boot may reuse the cached lease as a
+    // static IP, skipping DHCP, while it is younger than STATIC_IP_MAX_AGE_S;
+    // later reconnects go through DHCP so the lease gets renewed
+    bool cached = useApCache && apCache.magic == AP_CACHE_MAGIC;
+    int64_t leaseAge = (int64_t)time(NULL) - apCache.leasedAt;
+    wifiStaticIp = cached && FAST_BOOT_STATIC_IP && apCache.ip && !staticIpTried && leaseAge >= 0 &&
+                   leaseAge < STATIC_IP_MAX_AGE_S;
+    staticIpTried = true;
+    if (wifiStaticIp) {
+        WiFi.config(IPAddress(apCache.ip), IPAddress(apCache.gateway), IPAddress(apCache.subnet),
+                    IPAddress(apCache.dns));
+    } else {
+        WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));  // DHCP
     }
     
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println();
-        Serial.print("[WiFi] Connected! IP: ");
-        Serial.println(WiFi.localIP());
+    if (cached) {
+        Serial.printf("[WiFi] Reconnecting to %s on channel %d\n", WIFI_SSID, (int)apCache.channel);
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD, apCache.channel, apCache.bssid);
     } else {
-        Serial.println();
-        Serial.println("[WiFi] Connection failed - will retry later");
+        Serial.printf("[WiFi] Connecting to %s\n", WIFI_SSID);
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    }
+}
+
+// Restore the cached AP after a power-on, when RTC memory is garbage
+void loadApCache() {
+    if (apCache.magic == AP_CACHE_MAGIC) {
+        return;
+    }
+    if (prefs.getBytes("ap", &apCache, sizeof(apCache)) != sizeof(apCache) || apCache.magic != AP_CACHE_MAGIC) {
+        apCache.magic = 0;
+    }
+    // The clock restarted with the power: no telling how old the lease is
+    apCache.ip = 0;
+}
+
+// Only called with a DHCP result; only writes flash when the AP or lease
+// actually changed
+void saveApCache() {
+    ApCache current;
+    memset(&current, 0, sizeof(current));
+    current.magic = AP_CACHE_MAGIC;
+    memcpy(current.bssid, WiFi.BSSID(), sizeof(current.bssid));
+    current.channel = WiFi.channel();
+    current.ip = WiFi.localIP();
+    current.gateway = WiFi.gatewayIP();
+    current.subnet = WiFi.subnetMask();
+    current.dns = WiFi.dnsIP();
+    current.leasedAt = apCache.leasedAt;
+    
+    bool changed = memcmp(&current, &apCache, sizeof(current)) != 0;
+    memcpy(&apCache, &current, sizeof(apCache));
+    apCache.leasedAt = time(NULL);
+    if (changed) {
+        prefs.putBytes("ap", &apCache, sizeof(apCache));
+    }
+}
+
+void wifiConnected(unsigned long now) {
+    uint32_t took = now - wifiDownSince;
+    
+    wifiState = LINK_UP;
+    wifiBackoffMs = WIFI_BACKOFF_MIN_MS;
+    useApCache = true;
+    wifiStats.connects++;
+    wifiStats.lastReconnectMs = took;
+    wifiStats.totalReconnectMs += took;
+    if (took > wifiStats.maxReconnectMs) {
+        wifiStats.maxReconnectMs = took;
+    }
+    
+    if (!wifiStaticIp) {
+        saveApCache();  // A static IP is the cache itself: only DHCP renews it
     }
+    
+    Serial.printf("[WiFi] Connected in %u ms, IP: %s%s\n", (unsigned)took, WiFi.localIP().toString().c_str(),
+                  wifiStaticIp ? " (cached lease)" : "");
+}
+
+void wifiAttemptFailed(unsigned long now) {
+    WiFi.disconnect();
+    
+    // A cached AP that failed may have moved: scan next time
+    useApCache = false;
+    
+    // Jitter keeps several hubs from retrying in lockstep after an AP reboot
+    unsigned long wait = random(wifiBackoffMs / 2, wifiBackoffMs * 3 / 2);
+    wifiNextAttempt = now + wait;
+    wifiBackoffMs = min(wifiBackoffMs * 2, WIFI_BACKOFF_MAX_MS);
+    wifiState = LINK_DOWN;
+    
+    Serial.printf("[WiFi] Attempt failed, retrying in %lu ms\n", wait);
 }
 
-bool sendSensorData(float temp, float humidity, int moisture) {
+// Advances the connection without blocking; true while connected. A drop
+// is retried at once against the last access point (no scan), then with a
+// full scan and a jittered exponential backoff.
+bool wifiTick(unsigned long now) {
+    bool linkUp = wifiLinkUp;
+    
+    switch (wifiState) {
+    case LINK_UP:
+        if (!linkUp) {
+            Serial.println("[WiFi] Connection lost");
+            wifiStats.drops++;
+            wifiDownSince = now;
+            startWiFiAttempt(now);  // First retry right away, to the cached AP
+        }
+        break;
+    
+    case LINK_CONNECTING:
+        if (linkUp) {
+            wifiConnected(now);
+        } else if (wifiDisconnectEvents != wifiDisconnectsAtStart ||
+                   now - wifiAttemptStart >= WIFI_ATTEMPT_TIMEOUT_MS) {
+            wifiAttemptFailed(now);
+        }
+        break;
+    
+    case LINK_DOWN:
+        if (linkUp) {
+            wifiConnected(now);
+        } else if ((long)(now - wifiNextAttempt) >= 0) {
+            startWiFiAttempt(now);
+        }
+        break;
+    }
+    return wifiState == LINK_UP;
+}
+
+// Post up to BATCH_MAX of the oldest buffered samples; they are only
+// dropped from the ring once the server has answered
+bool sendBatch(const Summary *summary) {
     if (WiFi.status() != WL_CONNECTED) {
         Serial.println("[HTTP] WiFi not connected, skipping send");
         return false;
     }
     
-    HTTPClient http;
-    http.begin(SERVER_URL);
-    http.addHeader("Content-Type", "application/json");
-    http.setTimeout(HTTP_TIMEOUT_MS);
+    uint16_t count = min((int)sampleRing.count(), BATCH_MAX);
+    unsigned long start = millis();
+    
+    // Encode oldest sample first, straight into payloadBuf. Ages are
+    // relative to now, the server turns them into timestamps.
+    PayloadWriter payload(payloadBuf, sizeof(payloadBuf), UPLOAD_FORMAT);
+    size_t length;
+    for (;;) {
+        payload.begin(count, summary != NULL);
+        for (uint16_t i = 0; i < count; i++) {
+            const Sample &sample = sampleRing.at(i);
+            payload.add(sample, start - sample.takenAt);
+        }
+        if (summary) {
+            payload.summary(*summary, start - summary->takenAt);
+        }
+        length = payload.finish();
+        if (length > 0) {
+            break;
+        }
+        
+        // PAYLOAD_SIZE(BATCH_MAX) should always fit. If not, send the older
+        // half and leave the rest in the ring for the next batch.
+        if (count > 1) {
+            Serial.printf("[HTTP] %u samples overflow the %u-byte payload, sending %u\n", (unsigned)count,
+                          (unsigned)sizeof(payloadBuf), (unsigned)(count / 2));
+            count /= 2;
+        } else if (summary) {
+            Serial.println("[HTTP] Summary overflows the payload, dropping it");  // it would never fit
+            summary = NULL;
+        } else {
+            Serial.println("[HTTP] Sample overflows the payload, keeping it");
+            uploadStats.failed++;
+            return false;
+        }
+    }
     
-    // Build JSON payload
-    String json = "{";
-    json += "\"temp\":" + String(temp, 1) + ",";
-    json += "\"humidity\":" + String((int)humidity) + ",";
-    json += "\"moisture\":" + String(moisture);
-    json += "}";
+    // Reuses the open connection to the same host, if there is one
+    http.begin(uploadClient, SERVER_URL);
+    http.setReuse(true);
+    http.addHeader("Content-Type", payload.contentType());
+    http.setTimeout(HTTP_TIMEOUT_MS);
     
-    Serial.print("[HTTP] POST ");
-    Serial.print(SERVER_URL);
-    Serial.print(" -> ");
-    Serial.println(json);
+    Serial.printf("[HTTP] POST %u samples%s (%u bytes)\n", (unsigned)count, summary ? " + summary" : "",
+                  (unsigned)length);
     
-    int httpCode = http.POST(json);
+    int httpCode = http.POST(payloadBuf, length);
+    bool ok = httpCode > 0;
     
-    if (httpCode > 0) {
+    if (ok) {
         Serial.print("[HTTP] Response: ");
         Serial.println(httpCode);
+        // Read the whole body, or the connection can't be reused
+        String response = http.getString();
         if (httpCode == HTTP_CODE_OK) {
-            String response = http.getString();
             Serial.println(response);
         }
-        http.end();
-        return true;
     } else {
         Serial.print("[HTTP] Error: ");
         Serial.println(http.errorToString(httpCode));
-        http.end();
+    }
+    http.end();  // Keeps the connection open for the next POST
+    
+    uint32_t latency = millis() - start;
+    uploadStats.lastLatencyMs = latency;
+    if (latency > uploadStats.maxLatencyMs) {
+        uploadStats.maxLatencyMs = latency;
+    }
+    
+    // Server errors are retried; anything it rejected is not worth resending
+    if (!ok || httpCode >= 500) {
+        uploadStats.failed++;
         return false;
     }
+    if (httpCode != HTTP_CODE_OK) {
+        Serial.println("[HTTP] Batch rejected, dropping it");
+    }
+    sampleRing.drop(count);
+    uploadStats.sent += count;
+    uploadStats.batches++;
+    uploadStats.totalLatencyMs += latency;
+    return true;
+}
+
+// Unsent summaries, a newer one of a channel replacing the older. Only
+// used by the upload task.
+Summary summaries[CHANNEL_MAX];
+bool summaryPending[CHANNEL_MAX];
+
+// The oldest unsent summary, or NULL
+const Summary *nextSummary() {
+    const Summary *oldest = NULL;
+    for (int ch = 0; ch < CHANNEL_MAX; ch++) {
+        if (summaryPending[ch] && (!oldest || (int32_t)(summaries[ch].takenAt - oldest->takenAt) < 0)) {
+            oldest = &summaries[ch];
+        }
+    }
+    return oldest;
+}
+
+// Upload task: owns WiFi reconnects and HTTP, so loop() never waits on them.
+// Batches go out every BATCH_SIZE samples or BATCH_MAX_WAIT_MS, over one
+// keep-alive connection, and everything at once after an outage.
+void uploadTask(void *param) {
+    Sample sample;
+    Summary summary;
+    bool backlog = true;  // Send the first sample, and anything left from before a reset, at once
+    
+    for (;;) {
+        // Buffer everything sampled so far
+        while (xQueueReceive(sampleQueue, &sample, 0) == pdTRUE) {
+            if (!sampleRing.push(sample)) {
+                uploadStats.overwritten++;
+            }
+        }
+        while (xQueueReceive(summaryQueue, &summary, 0) == pdTRUE) {
+            summaries[summary.channel] = summary;
+            summaryPending[summary.channel] = true;
+        }
+        const Summary *pending = nextSummary();
+        
+        if (!wifiTick(millis())) {
+            backlog = true;  // Flush the outage as soon as we're back
+            xQueuePeek(sampleQueue, &sample, pdMS_TO_TICKS(WIFI_POLL_MS));
+            continue;
+        }
+        
+        bool stale = sampleRing.count() > 0 && millis() - sampleRing.at(0).takenAt >= BATCH_MAX_WAIT_MS;
+        if (sampleRing.count() >= BATCH_SIZE || stale || (backlog && sampleRing.count() > 0) || pending) {
+            if (sendBatch(pending)) {
+                if (pending) {
+                    summaryPending[pending->channel] = false;
+                }
+            } else {
+                vTaskDelay(pdMS_TO_TICKS(RETRY_DELAY_MS));  // Back off, samples stay buffered
+            }
+            backlog = sampleRing.count() > 0;
+            continue;
+        }
+        
+        // Wait for the next sample
+        xQueuePeek(sampleQueue, &sample, pdMS_TO_TICKS(1000));
+    }
+}
+
+// The DHT11 is read without blocking: loop() drives the start pulse, the
+// RMT peripheral records the answer while the CPU sleeps, and lib/DhtDecoder
+// turns the pulses into a reading. Nothing runs with interrupts off.
+// The DHT lines are open-drain with the RMT receiver on one of them, so
+// loop() can pull it low for the start pulse and then just let go and listen
+void dhtBegin() {
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        if (SENSORS[i].type == SENSOR_DHT11 && dhtPin < 0) {
+            dhtPin = SENSORS[i].pin;
+        }
+    }
+    if (dhtPin < 0) {
+        return;
+    }
+    
+    rmt_config_t config = RMT_DEFAULT_CONFIG_RX((gpio_num_t)dhtPin, DHT_RMT_CHANNEL);
+    config.clk_div = 80;                          // 1 us ticks
+    config.mem_block_num = 2;                     // A frame is ~43 items, an S3 block holds 48
+    config.rx_config.filter_en = true;
+    config.rx_config.filter_ticks_thresh = 100;   // APB ticks: ignore glitches under ~1 us
+    config.rx_config.idle_threshold = DHT_IDLE_US;
+    rmt_config(&config);
+    rmt_driver_install(DHT_RMT_CHANNEL, 1024, 0);
+    rmt_get_ringbuf_handle(DHT_RMT_CHANNEL, &dhtRing);
+
+    // After rmt_config(), which leaves the pin input-only
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        if (SENSORS[i].type == SENSOR_DHT11) {
+            gpio_num_t pin = (gpio_num_t)SENSORS[i].pin;
+            gpio_set_direction(pin, GPIO_MODE_INPUT_OUTPUT_OD);
+            gpio_set_pull_mode(pin, GPIO_PULLUP_ONLY);
+            gpio_set_level(pin, 1);
+        }
+    }
+}
+
+// Start reading SENSORS[index]; one RMT channel serves every DHT11, moved
+// to its pin between reads
+void dhtStart(int index, unsigned long now) {
+    gpio_num_t pin = (gpio_num_t)SENSORS[index].pin;
+    if (pin != dhtPin) {
+        rmt_set_gpio(DHT_RMT_CHANNEL, RMT_MODE_RX, pin, false);
+        gpio_set_direction(pin, GPIO_MODE_INPUT_OUTPUT_OD);  // rmt_set_gpio() made it input-only
+        dhtPin = pin;
+    }
+    gpio_set_level(pin, 0);
+    dhtSensor = index;
+    dhtPhase = DHT_START;
+    dhtPhaseStart = now;
+}
+
+// Advance a read begun by dhtStart(). Returns true once it is over, with
+// *status set and *reading filled on DHT_OK.
+bool dhtPoll(unsigned long now, DhtStatus *status, DhtReading *reading) {
+    if (dhtPhase == DHT_START) {
+        if (now - dhtPhaseStart < DHT_START_MS) {
+            return false;
+        }
+        rmt_rx_start(DHT_RMT_CHANNEL, true);
+        gpio_set_level((gpio_num_t)dhtPin, 1);
+        dhtPhase = DHT_CAPTURE;
+        dhtPhaseStart = now;
+        return false;
+    }
+    if (dhtPhase != DHT_CAPTURE) {
+        return false;
+    }
+    
+    size_t size = 0;
+    rmt_item32_t *items = (rmt_item32_t *)xRingbufferReceive(dhtRing, &size, 0);
+    if (items) {
+        // Each item is two levels; a zero duration marks the end
+        size_t count = 0;
+        for (size_t i = 0; i < size / sizeof(rmt_item32_t) && count + 2 <= DHT_CAPTURE_SPANS; i++) {
+            if (!items[i].duration0) {
+                break;
+            }
+            dhtSpans[count++] = {(uint16_t)items[i].duration0, (uint8_t)items[i].level0};
+            if (!items[i].duration1) {
+                break;
+            }
+            dhtSpans[count++] = {(uint16_t)items[i].duration1, (uint8_t)items[i].level1};
+        }
+        vRingbufferReturnItem(dhtRing, items);
+        *status = dhtDecode(dhtSpans, count, DHT_MODEL_11, reading);
+    } else if (now - dhtPhaseStart < DHT_FRAME_TIMEOUT_MS) {
+        return false;
+    } else {
+        *status = DHT_NO_RESPONSE;
+    }
+    
+    rmt_rx_stop(DHT_RMT_CHANNEL);
+    dhtPhase = DHT_IDLE;
+    return true;
+}
+
+// How long loop() may sleep before the read needs it again
+unsigned long dhtWaitMs(unsigned long now) {
+    if (dhtPhase == DHT_START) {
+        unsigned long held = now - dhtPhaseStart;
+        return held < DHT_START_MS ? DHT_START_MS - held : 0;
+    }
+    return 1;
+}
+
+// One burst of MOISTURE_BURST back-to-back reads through the probe's filter
+// (lib/AdcFilter: median of the burst, then an integer EMA)
+int readMoisture(int index) {
+    AdcFilter &filter = sensors[index]->filter;
+    uint16_t raw[ADC_FILTER_MAX_BURST];
+    for (uint8_t i = 0; i < filter.burst(); i++) {
+        raw[i] = analogRead(SENSORS[index].pin);
+    }
+    return filter.add(raw, filter.burst());
+}
+
+// NVS key of a probe's endpoints: moist_cal for channel 0, moist_cal<ch> for the others
+void calibrationKey(uint8_t channel, char *key, size_t size) {
+    snprintf(key, size, channel ? "moist_cal%u" : "moist_cal", (unsigned)channel);
+}
+
+// With MOISTURE_CALIBRATED samples also carry moisture_pct, scaled between
+// these dry and wet endpoints (see handleConsole())
+void loadCalibration() {
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        if (SENSORS[i].type != SENSOR_MOISTURE) {
+            continue;
+        }
+        char key[16];
+        calibrationKey(SENSORS[i].channel, key, sizeof(key));
+        MoistureCalibration stored;
+        if (prefs.getBytes(key, &stored, sizeof(stored)) == sizeof(stored) && stored.dry != stored.wet) {
+            sensors[i]->cal = stored;
+        }
+        Serial.printf("[Sensor] ch%u moisture calibration dry=%u wet=%u\n", SENSORS[i].channel,
+                      sensors[i]->cal.dry, sensors[i]->cal.wet);
+    }
+}
+
+// "cal dry [ch]" / "cal wet [ch]": the current filtered reading of the
+// channel's probe (0 if left out) becomes that endpoint
+void handleConsole() {
+    while (Serial.available() > 0) {
+        char c = Serial.read();
+        if (c != '\n' && c != '\r') {
+            if (consoleLength < sizeof(consoleLine) - 1) {
+                consoleLine[consoleLength++] = c;
+            }
+            continue;
+        }
+        consoleLine[consoleLength] = '\0';
+        consoleLength = 0;
+        
+        bool dry = strncmp(consoleLine, "cal dry", 7) == 0;
+        if (!dry && strncmp(consoleLine, "cal wet", 7) != 0) {
+            continue;
+        }
+        int channel = atoi(consoleLine + 7);
+        int probe = -1;
+        for (int i = 0; i < SENSOR_COUNT; i++) {
+            if (SENSORS[i].type == SENSOR_MOISTURE && SENSORS[i].channel == channel) {
+                probe = i;
+            }
+        }
+        if (probe < 0) {
+            Serial.printf("[Sensor] No moisture probe on ch%d\n", channel);
+            continue;
+        }
+        
+        MoistureCalibration &cal = sensors[probe]->cal;
+        uint16_t counts = sensors[probe]->filter.value();
+        if (dry) {
+            cal.dry = counts;
+        } else {
+            cal.wet = counts;
+        }
+        char key[16];
+        calibrationKey(channel, key, sizeof(key));
+        prefs.putBytes(key, &cal, sizeof(cal));
+        Serial.printf("[Sensor] ch%d moisture calibration dry=%u wet=%u\n", channel, cal.dry, cal.wet);
+    }
+}
+
+// Which of a sensor's fields moved past their deadband since they were last
+// reported; all of them for its first report and after HEARTBEAT_MS of silence
+uint8_t changedFields(const Sample &sample, uint8_t sensorFields, const SensorState &sensor, unsigned long now) {
+    if (!sensor.reportedOnce || now - sensor.lastReportTime >= HEARTBEAT_MS) {
+        return sensorFields;
+    }
+    
+    const Sample &lastReported = channels[sample.channel]->lastReported;
+    uint8_t fields = 0;
+    if (fabsf(sample.temp - lastReported.temp) >= TEMP_DEADBAND_C) {
+        fields |= SAMPLE_TEMP;
+    }
+    if (fabsf(sample.humidity - lastReported.humidity) >= HUMIDITY_DEADBAND) {
+        fields |= SAMPLE_HUMID;
+    }
+    if (abs(sample.moisture - lastReported.moisture) >= MOISTURE_DEADBAND) {
+        fields |= SAMPLE_MOIST;
+    }
+    return fields & sensorFields;
+}
+
+// Remember what was reported; fields left out keep their old reference,
+// so a slow drift is still reported once it adds up to a deadband
+void markReported(const Sample &sample, SensorState &sensor, unsigned long now) {
+    Sample &lastReported = channels[sample.channel]->lastReported;
+    if (sample.fields & SAMPLE_TEMP) {
+        lastReported.temp = sample.temp;
+    }
+    if (sample.fields & SAMPLE_HUMID) {
+        lastReported.humidity = sample.humidity;
+    }
+    if (sample.fields & SAMPLE_MOIST) {
+        lastReported.moisture = sample.moisture;
+    }
+    sensor.lastReportTime = now;
+    sensor.reportedOnce = true;
+}
+
+// Hand a sample to a task without waiting; false if the oldest queued one
+// had to be dropped for it (the newest matters more)
+bool handOff(QueueHandle_t queue, const Sample &sample) {
+    if (xQueueSend(queue, &sample, 0) == pdTRUE) {
+        return true;
+    }
+    Sample oldest;
+    xQueueReceive(queue, &oldest, 0);
+    xQueueSend(queue, &sample, 0);
+    return false;
+}
+
+void queueSample(const Sample &sample) {
+    if (SERVER_UPLOAD && UPLOAD_SAMPLES && !handOff(sampleQueue, sample)) {
+        uploadStats.dropped++;
+    }
+    if (UNO_LINK) {
+        handOff(unoQueue, sample);  // Unsent values are superseded anyway
+    }
+}
+
+// Every reading goes into its channel's rolling windows (lib/RollingStats:
+// min/max/mean/deviation over STATS_WINDOW samples and a least-squares
+// moisture trend), reported or not. A summary with dry_in_h, the hours until
+// the trend reaches DRY_THRESHOLD, goes to the upload task every
+// SUMMARY_INTERVAL_MS, the channels taking turns.
+void updateStats(const Sample &sample, uint8_t sensorFields, unsigned long now) {
+    ChannelState &channel = *channels[sample.channel];
+    uint32_t seconds = esp_timer_get_time() / 1000000;  // millis() wraps after 49.7 days
+    if (sensorFields & SAMPLE_TEMP) {
+        channel.temp.add(seconds, lroundf(sample.temp * 10));
+    }
+    if (sensorFields & SAMPLE_HUMID) {
+        channel.humidity.add(seconds, lroundf(sample.humidity));
+    }
+    if (sensorFields & SAMPLE_MOIST) {
+        channel.moisture.add(seconds, sample.moisture);
+    }
+    
+    if ((long)(now - channel.nextSummaryAt) < 0) {
+        return;
+    }
+    channel.nextSummaryAt = now + SUMMARY_INTERVAL_MS;
+    
+    Summary summary;
+    summary.takenAt = now;
+    summary.channel = sample.channel;
+    summary.fields = (channel.temp.count() ? SAMPLE_TEMP : 0) | (channel.humidity.count() ? SAMPLE_HUMID : 0) |
+                     (channel.moisture.count() ? SAMPLE_MOIST : 0);
+    summary.window = channel.moisture.count() ? channel.moisture.count() : channel.temp.count();
+    summary.tempMin = channel.temp.min() / 10.0f;
+    summary.tempMax = channel.temp.max() / 10.0f;
+    summary.tempMean = channel.temp.mean() / 10.0f;
+    summary.tempStddev = sqrtf(channel.temp.variance()) / 10.0f;
+    summary.humidityMean = channel.humidity.mean();
+    summary.moistureMin = channel.moisture.min();
+    summary.moistureMax = channel.moisture.max();
+    summary.moistureMean = channel.moisture.mean();
+    summary.moistureStddev = sqrtf(channel.moisture.variance());
+    summary.moisturePerHour = channel.moisture.slopePerHour();
+    summary.hoursToDry = channel.moisture.hoursUntilBelow(DRY_THRESHOLD);
+    
+    Serial.printf("[Stats] ch%u n=%u temp %.1f-%.1f C moisture mean=%.0f sd=%.1f trend=%.1f/h dry_in=%.1f h\n",
+                  (unsigned)summary.channel, (unsigned)summary.window, summary.tempMin, summary.tempMax,
+                  summary.moistureMean, summary.moistureStddev, summary.moisturePerHour, summary.hoursToDry);
+    if (SERVER_UPLOAD && xQueueSend(summaryQueue, &summary, 0) != pdTRUE) {
+        Serial.println("[Stats] Summary queue full, dropped");
+    }
+}
+
+// A reading of SENSORS[index]: report the fields that changed, keep the statistics
+void handleReading(int index, Sample &sample, uint8_t sensorFields, unsigned long now) {
+    SensorState &sensor = *sensors[index];
+    
+    sample.fields = changedFields(sample, sensorFields, sensor, now);
+    if (!bootReported) {
+        // boot_ms: how long fast boot took to a first reading
+        sample.fields |= SAMPLE_BOOT;
+        bootReported = true;
+        Serial.printf("[Boot] First sample %lu ms after boot\n", now);
+    }
+    if (sample.fields) {
+        markReported(sample, sensor, now);
+        queueSample(sample);
+    } else {
+        samplesUnchanged++;
+    }
+    updateStats(sample, sensorFields, now);
+    
+    uint32_t interval = sensor.scheduler.interval();
+    sensor.scheduler.record(now, sample.temp, sample.moisture);
+    if (sensor.scheduler.interval() != interval) {
+        Serial.printf("[Sample] ch%u %s interval %u ms\n", (unsigned)sample.channel,
+                      SENSORS[index].type == SENSOR_DHT11 ? "DHT11" : "moisture",
+                      (unsigned)sensor.scheduler.interval());
+    }
+}
+
+void dhtDone(int index, DhtStatus status, const DhtReading &data, unsigned long now) {
+    uint8_t channel = SENSORS[index].channel;
+    
+    if (status != DHT_OK) {
+        Serial.printf("[Sensor] ch%u DHT11 error: %s\n", (unsigned)channel, dhtStatusString(status));
+        sensors[index]->errors++;
+        sensors[index]->scheduler.retry(now);
+        return;
+    }
+    Serial.printf("[ch%u] Temp: %.1fC | Humidity: %.0f%%\n", (unsigned)channel, data.temperature, data.humidity);
+    
+    Sample sample = {data.temperature, data.humidity, 0, (uint32_t)now, 0, -1, channel};
+    handleReading(index, sample, SAMPLE_TEMP | SAMPLE_HUMID, now);
+}
+
+void probeRead(int index, unsigned long now) {
+    SensorState &sensor = *sensors[index];
+    uint8_t channel = SENSORS[index].channel;
+    int moisture = readMoisture(index);
+    Serial.printf("[ch%u] Moisture: %d (median %u)\n", (unsigned)channel, moisture,
+                  (unsigned)sensor.filter.lastMedian());
+    
+    int8_t percent = MOISTURE_CALIBRATED ? moisturePercent(moisture, sensor.cal) : -1;
+    Sample sample = {0, 0, moisture, (uint32_t)now, 0, percent, channel};
+    handleReading(index, sample, SAMPLE_MOIST, now);
+}
+
+// The next sensor of a type that is due, looking from the one after
+// *cursor on so that each gets its turn; -1 if none is
+int nextDue(SensorType type, unsigned long now, int *cursor) {
+    for (int n = 1; n <= SENSOR_COUNT; n++) {
+        int i = (*cursor + n + SENSOR_COUNT) % SENSOR_COUNT;
+        if (SENSORS[i].type == type && sensors[i]->scheduler.due(now)) {
+            *cursor = i;
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Schedules and channel state for the SENSORS table. Each sensor has its
+// own schedule (or the table's fixed interval), and first reads are
+// SENSOR_STAGGER_MS apart so they stay spread out.
+void sensorsBegin(unsigned long now) {
+    int used = 0;
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        const SensorConfig &config = SENSORS[i];
+        unsigned long minInterval = MIN_SAMPLE_INTERVAL_MS;
+        unsigned long maxInterval = MAX_SAMPLE_INTERVAL_MS;
+        if (config.intervalMs) {
+            minInterval = maxInterval = config.intervalMs;
+        }
+        if (config.type == SENSOR_DHT11) {
+            minInterval = max(minInterval, DHT_MIN_INTERVAL_MS);
+            maxInterval = max(maxInterval, minInterval);
+        }
+        
+        sensors[i] = new SensorState({(uint32_t)minInterval, (uint32_t)maxInterval, TEMP_RATE_PER_MIN,
+                                      MOISTURE_RATE_PER_MIN, TEMP_DEADBAND_C, MOISTURE_DEADBAND, STABLE_SAMPLES});
+        sensors[i]->scheduler.startAt(now + i * SENSOR_STAGGER_MS);
+        if (!channels[config.channel]) {
+            channels[config.channel] = new ChannelState();
+            used++;
+        }
+        
+        if (config.type == SENSOR_DHT11) {
+            Serial.printf("[Sensor] ch%u DHT11 on GPIO %d\n", config.channel, config.pin);
+        } else {
+            Serial.printf("[Sensor] ch%u moisture on GPIO %d, median of %d reads\n", config.channel, config.pin,
+                          MOISTURE_BURST);
+        }
+    }
+    
+    // Spread the channels' summaries over the interval
+    int k = 0;
+    for (int ch = 0; ch < CHANNEL_MAX; ch++) {
+        if (channels[ch]) {
+            channels[ch]->nextSummaryAt = now + SUMMARY_INTERVAL_MS + k++ * SUMMARY_INTERVAL_MS / used;
+        }
+    }
+}
+
+void writeToUno(const char *data, size_t len) {
+    Serial1.write((const uint8_t *)data, len);
+}
+
+// Uno task: reported samples go to the Uno as its tagged S T/S H/S M
+// commands, every channel, with windowed acks for flow control
+// (lib/UnoLink), so the display keeps updating without the PC
+void unoTask(void *param) {
+    Sample sample;
+    
+    unoLink.begin();  // The Uno may have kept running through our reset
+    for (;;) {
+        while (xQueueReceive(unoQueue, &sample, 0) == pdTRUE) {
+            unoLink.send(sample);
+        }
+        while (Serial1.available() > 0) {
+            unoLink.receive(Serial1.read(), millis());
+        }
+        unoLink.poll(millis());
+        
+        // Next sample, or the next look for acks while commands are in flight
+        xQueuePeek(unoQueue, &sample, pdMS_TO_TICKS(unoLink.idle() ? 1000 : UNO_POLL_MS));
+    }
+}
+
+void printUploadStats() {
+    if (UNO_LINK) {
+        const UnoLinkStats &uno = unoLink.stats();
+        Serial.printf("[Uno] sent=%u resent=%u acked=%u replaced=%u naks=%u busy=%u timeouts=%u dropped=%u "
+                      "resyncs=%u\n",
+                      (unsigned)uno.sent, (unsigned)uno.resent, (unsigned)uno.acked, (unsigned)uno.replaced,
+                      (unsigned)uno.naks, (unsigned)uno.busy, (unsigned)uno.timeouts, (unsigned)uno.dropped,
+                      (unsigned)uno.resyncs);
+    }
+    Serial.print("[Sensor] interval_ms/errors");
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        Serial.printf(" ch%u:%s=%u/%u", SENSORS[i].channel, SENSORS[i].type == SENSOR_DHT11 ? "dht" : "moist",
+                      (unsigned)sensors[i]->scheduler.interval(), (unsigned)sensors[i]->errors);
+    }
+    Serial.println();
+    if (!SERVER_UPLOAD) {
+        Serial.printf("[Upload] off, unchanged=%u\n", (unsigned)samplesUnchanged);
+        return;
+    }
+    
+    uint32_t sent = uploadStats.sent;
+    
+    uint32_t batches = uploadStats.batches;
+    
+    Serial.printf("[Upload] unchanged=%u sent=%u batches=%u failed=%u dropped=%u overwritten=%u "
+                  "queue=%u/%d buffered=%u latency_ms last=%u avg=%u max=%u\n",
+                  (unsigned)samplesUnchanged, (unsigned)sent, (unsigned)batches, (unsigned)uploadStats.failed,
+                  (unsigned)uploadStats.dropped, (unsigned)uploadStats.overwritten,
+                  (unsigned)uxQueueMessagesWaiting(sampleQueue), SAMPLE_QUEUE_LEN,
+                  (unsigned)sampleRing.count(), (unsigned)uploadStats.lastLatencyMs,
+                  (unsigned)(batches ? uploadStats.totalLatencyMs / batches : 0),
+                  (unsigned)uploadStats.maxLatencyMs);
+    
+    uint32_t connects = wifiStats.connects;
+    Serial.printf("[WiFi] %s attempts=%u connects=%u drops=%u reconnect_ms last=%u avg=%u max=%u\n",
+                  wifiState == LINK_UP ? "up" : "down", (unsigned)wifiStats.attempts, (unsigned)connects,
+                  (unsigned)wifiStats.drops, (unsigned)wifiStats.lastReconnectMs,
+                  (unsigned)(connects ? wifiStats.totalReconnectMs / connects : 0),
+                  (unsigned)wifiStats.maxReconnectMs);
 }
 
 void setup() {
     Serial.begin(115200);
-    delay(1000);
+    
+    // Only a cold sensor needs to settle; after a brownout, watchdog or
+    // software reset take the first reading right away
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (reason == ESP_RST_POWERON) {
+        delay(DHT_POWER_UP_MS);
+    }
     
     Serial.println("================================");
     Serial.println("ESP32 Sensor Hub Starting...");
+    Serial.printf("[Boot] Reset reason %d, %s boot\n", (int)reason, reason == ESP_RST_POWERON ? "cold" : "fast");
     Serial.println("================================");
     
-    // Initialize DHT sensor
-    dht.setup(DHT_PIN, DHTesp::DHT11);
-    Serial.println("[Sensor] DHT11 initialized on GPIO " + String(DHT_PIN));
-    Serial.println("[Sensor] Moisture on GPIO " + String(MOISTURE_PIN));
+    // Initialize the sensors
+    sensorsBegin(millis());
+    dhtBegin();
+    prefs.begin("sensorhub", false);
+    loadCalibration();
+    
+    if (UNO_LINK) {
+        Serial1.begin(UNO_BAUD, SERIAL_8N1, UNO_RX_PIN, UNO_TX_PIN);
+        unoQueue = xQueueCreate(SAMPLE_QUEUE_LEN, sizeof(Sample));
+        xTaskCreatePinnedToCore(unoTask, "uno", UNO_STACK_SIZE, NULL, 1, NULL, UPLOAD_CORE);
+        Serial.printf("[Uno] Direct link on Serial1 (RX %d, TX %d)\n", UNO_RX_PIN, UNO_TX_PIN);
+    }
+    if (!SERVER_UPLOAD) {
+        Serial.println("[Ready] Server upload off");
+        Serial.println("================================");
+        return;
+    }
+    
+    // The upload task connects; sampling starts without waiting for WiFi
+    loadApCache();
+    WiFi.persistent(false);        // ApCache is all we keep, don't rewrite the WiFi NVS on begin()
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);  // wifiTick() owns reconnects
+    WiFi.onEvent(onWiFiEvent);
     
-    // Connect to WiFi
-    connectWiFi();
+    // Keep samples buffered before a soft reset, start clean after power-on
+    if (sampleRing.valid()) {
+        sampleRing.rebase();
+        Serial.printf("[Upload] %u buffered samples kept\n", (unsigned)sampleRing.count());
+    } else {
+        sampleRing.clear();
+    }
     
-    Serial.println("[Ready] Sending data to " + String(SERVER_URL));
+    // Start uploading on the other core
+    sampleQueue = xQueueCreate(SAMPLE_QUEUE_LEN, sizeof(Sample));
+    summaryQueue = xQueueCreate(SAMPLE_QUEUE_LEN, sizeof(Summary));
+    xTaskCreatePinnedToCore(uploadTask, "upload", UPLOAD_STACK_SIZE, NULL, 1, NULL, UPLOAD_CORE);
+    
+    Serial.printf("[Ready] Sending data to %s\n", SERVER_URL);
     Serial.println("================================");
 }
 
 void loop() {
     unsigned long currentTime = millis();
     
-    // Reconnect WiFi if disconnected
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("[WiFi] Reconnecting...");
-        connectWiFi();
+    // One DHT11 read at a time, the due ones taking turns; the upload and
+    // Uno tasks send what gets reported. A pass costs the same however many
+    // sensors there are, more sensors only wait longer for a turn.
+    if (dhtPhase == DHT_IDLE) {
+        int next = nextDue(SENSOR_DHT11, currentTime, &dhtCursor);
+        if (next >= 0) {
+            dhtStart(next, currentTime);
+        }
     }
     
-    // Send sensor data at interval
-    if (currentTime - lastSendTime >= SEND_INTERVAL_MS) {
-        lastSendTime = currentTime;
-        
-        TempAndHumidity data = dht.getTempAndHumidity();
-        int moisture = analogRead(MOISTURE_PIN);
-        
-        if (dht.getStatus() != DHTesp::ERROR_NONE) {
-            Serial.print("[Sensor] Error: ");
-            Serial.println(dht.getStatusString());
-        } else {
-            Serial.println("--------------------------------");
-            Serial.print("Temp: ");
-            Serial.print(data.temperature, 1);
-            Serial.print("C | Humidity: ");
-            Serial.print(data.humidity, 0);
-            Serial.print("% | Moisture: ");
-            Serial.println(moisture);
-            
-            sendSensorData(data.temperature, data.humidity, moisture);
+    DhtStatus status;
+    DhtReading data;
+    if (dhtPoll(currentTime, &status, &data)) {
+        dhtDone(dhtSensor, status, data, currentTime);
+    }
+    
+    // A few probe bursts per pass, however many are due; the rest come
+    // round on the next pass, right away
+    for (int n = 0; n < MOISTURE_BURSTS_PER_PASS; n++) {
+        int next = nextDue(SENSOR_MOISTURE, currentTime, &moistureCursor);
+        if (next < 0) {
+            break;
         }
+        probeRead(next, currentTime);
     }
     
-    // Small delay to prevent tight loop
-    delay(100);
-}
\ No newline at end of file
+    handleConsole();
+    
+    if (currentTime - lastStatsTime >= STATS_INTERVAL_MS) {
+        lastStatsTime = currentTime;
+        printUploadStats();
+    }
+    
+    // Sleep until the DHT read, the next sensor or the stats line needs us;
+    // DHT11s wait for the one being read to finish
+    unsigned long wait = STATS_INTERVAL_MS - (currentTime - lastStatsTime);
+    if (dhtPhase != DHT_IDLE) {
+        wait = min(wait, dhtWaitMs(currentTime));
+    }
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        if (SENSORS[i].type != SENSOR_DHT11 || dhtPhase == DHT_IDLE) {
+            wait = min(wait, (unsigned long)sensors[i]->scheduler.waitMs(currentTime));
+        }
+    }
+    delay(wait);
+}
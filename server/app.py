@@ -3,12 +3,16 @@ Flask server hub for ESP32 -> PC -> Arduino communication.
 
 Endpoints:
 - POST /sensor  - Receive sensor data from ESP32
+- POST /sensor/batch - Receive buffered sensor samples from ESP32
+- GET /sensor/summary - Latest rolling statistics from ESP32, per channel
 - POST /voice   - Receive voice text (manual or from PTT)
 - GET /health   - Health check
 """
 
 import os
 import threading
+import time
+import cbor2
 from flask import Flask, request, jsonify
 from dotenv import load_dotenv
 
@@ -23,17 +27,37 @@ app = Flask(__name__)
 # Global serial bridge instance
 bridge: SerialBridge = None
 
+# Latest rolling statistics from the ESP32 by channel, with the time they were computed
+latest_summaries: dict = {}
+
+# What the LCD shows: a channel (plant) number, "overview", or empty to let
+# the Uno switch to the overview once a second plant reports
+LCD_VIEW = os.getenv("LCD_VIEW", "").strip().lower()
+
 
 def get_bridge() -> SerialBridge:
     """Get or create serial bridge connection."""
     global bridge
     if bridge is None:
         port = os.getenv("ARDUINO_COM_PORT", "COM3")
-        bridge = SerialBridge(port)
-        bridge.connect()
+        binary = os.getenv("SERIAL_BINARY", "false").lower() == "true"
+        window = int(os.getenv("SERIAL_WINDOW", "0"))
+        bridge = SerialBridge(port, binary=binary, window=window)
+        if bridge.connect() and LCD_VIEW:
+            bridge.send_view(None if LCD_VIEW == "overview" else int(LCD_VIEW))
     return bridge
 
 
+def read_payload():
+    """Request body as JSON, or as CBOR when sent as application/cbor."""
+    if request.mimetype == "application/cbor":
+        try:
+            return cbor2.loads(request.get_data())
+        except (cbor2.CBORDecodeError, ValueError):
+            return None
+    return request.get_json()
+
+
 @app.route("/health", methods=["GET"])
 def health():
     """Health check endpoint."""
@@ -53,28 +77,28 @@ def sensor():
     {
         "temp": 23.7,      // optional
         "humidity": 41,    // optional  
-        "moisture": 78     // optional
+        "moisture": 78,    // optional
+        "ch": 3            // optional, the plant (0)
     }
+    
+    The same structure may be sent as CBOR (Content-Type: application/cbor).
     """
-    data = request.get_json()
+    data = read_payload()
     
-    if not data:
+    if not isinstance(data, dict) or not data:
         return jsonify({"error": "No JSON data"}), 400
     
     print(f"[ESP32] Received: {data}")
     
     b = get_bridge()
-    results = {}
-    
-    # Send each sensor value if present
-    if "temp" in data:
-        results["temp"] = b.send_temp(float(data["temp"]))
     
-    if "humidity" in data:
-        results["humidity"] = b.send_humidity(int(data["humidity"]))
+    # Send whichever sensor values are present as one sample
+    temp = round(float(data["temp"]), 1) if "temp" in data else None
+    humidity = int(data["humidity"]) if "humidity" in data else None
+    moisture = int(data["moisture"]) if "moisture" in data else None
     
-    if "moisture" in data:
-        results["moisture"] = b.send_moisture(int(data["moisture"]))
+    ok = b.send_sample(temp=temp, humidity=humidity, moisture=moisture, channel=int(data.get("ch", 0)))
+    results = {k: ok for k in ("temp", "humidity", "moisture") if k in data}
     
     return jsonify({
         "status": "ok",
@@ -82,6 +106,104 @@ def sensor():
     })
 
 
+@app.route("/sensor/batch", methods=["POST"])
+def sensor_batch():
+    """
+    Receive a batch of buffered samples from ESP32, oldest first.
+    
+    Expected JSON:
+    {
+        "samples": [
+            {"age_ms": 8000, "temp": 23.7, "humidity": 41, "moisture": 2100},
+            ...
+        ]
+    }
+    
+    age_ms is how long ago the sample was taken. Samples only carry the
+    fields that changed, and "ch", the plant they belong to, unless it is 0.
+    Every sample is logged with its timestamp; the newest value of each
+    field is sent to the LCD once per batch and channel.
+    The same structure may be sent as CBOR (Content-Type: application/cbor).
+    
+    A batch may also carry a "summary" of one channel's rolling statistics;
+    it is kept for GET /sensor/summary, and "samples" may then be empty.
+    """
+    data = read_payload()
+    
+    if not isinstance(data, dict) or not isinstance(data.get("samples"), list):
+        return jsonify({"error": "Missing 'samples' list"}), 400
+    summary = data.get("summary")
+    if not data["samples"] and not isinstance(summary, dict):
+        return jsonify({"error": "Empty batch"}), 400
+    
+    received_at = time.time()
+    try:
+        samples = [
+            {
+                "time": received_at - int(s.get("age_ms", 0)) / 1000,
+                "ch": int(s.get("ch", 0)),
+                "temp": round(float(s["temp"]), 1) if "temp" in s else None,
+                "humidity": int(s["humidity"]) if "humidity" in s else None,
+                "moisture": int(s["moisture"]) if "moisture" in s else None,
+                "moisture_pct": int(s["moisture_pct"]) if "moisture_pct" in s else None,
+            }
+            for s in data["samples"]
+        ]
+    except (TypeError, ValueError, AttributeError) as e:
+        return jsonify({"error": f"Bad sample: {e}"}), 400
+    
+    if isinstance(summary, dict):
+        ch = int(summary.get("ch", 0))
+        latest_summaries[ch] = dict(summary, ch=ch, time=received_at - int(summary.get("age_ms", 0)) / 1000)
+        dry_in = ""
+        if summary.get("dry_in_h") == 0:
+            dry_in = ", dry now"
+        elif "dry_in_h" in summary:
+            dry_in = f", dry in {summary['dry_in_h']} h"
+        print(f"[ESP32] ch{ch} summary of {summary.get('n')}: moisture mean={summary.get('moisture_mean')} "
+              f"trend={summary.get('moisture_per_hour')}/h{dry_in}")
+    
+    for s in data["samples"]:
+        if "boot_ms" in s:
+            print(f"[ESP32] Rebooted, first sample {s['boot_ms']} ms after boot")
+    
+    for s in samples:
+        stamp = time.strftime("%H:%M:%S", time.localtime(s["time"]))
+        pct = f" ({s['moisture_pct']}%)" if s["moisture_pct"] is not None else ""
+        print(f"[ESP32] {stamp} ch{s['ch']} temp={s['temp']} humidity={s['humidity']} "
+              f"moisture={s['moisture']}{pct}")
+    
+    # Newest value of each field each channel has in the batch
+    latest = {}
+    for s in samples:
+        latest.setdefault(s["ch"], {}).update(
+            {k: v for k, v in s.items() if k not in ("time", "ch", "moisture_pct") and v is not None})
+    
+    b = get_bridge()
+    ok = True
+    for ch, values in latest.items():
+        if values:
+            ok = b.send_sample(channel=ch, **values) and ok
+    
+    return jsonify({
+        "status": "ok",
+        "received": len(samples),
+        "sent": ok
+    })
+
+
+@app.route("/sensor/summary", methods=["GET"])
+def sensor_summary():
+    """Latest rolling statistics the ESP32 sent for ?ch=<n> (0), or 404 before the first."""
+    try:
+        ch = int(request.args.get("ch", 0))
+    except ValueError:
+        return jsonify({"error": "Bad channel"}), 400
+    if ch not in latest_summaries:
+        return jsonify({"error": "No summary yet"}), 404
+    return jsonify(latest_summaries[ch])
+
+
 @app.route("/voice", methods=["POST"])
 def voice():
     """
@@ -0,0 +1,88 @@
+"""
+Binary frames for the Server -> Uno link (see shared/protocol.md).
+
+Mirrors ArduinoUno-Firmware/lib/BinaryFrame: a frame is
+[type][seq][payload...][crc8], COBS-encoded and terminated by 0x00.
+"""
+
+import struct
+from typing import Optional
+
+
+FRAME_SAMPLE = 0x01
+FRAME_MOOD = 0x02
+FRAME_VOICE = 0x03
+FRAME_TEXT = 0x04
+FRAME_VIEW = 0x05
+
+VIEW_OVERVIEW = 0xFF
+
+SAMPLE_HAS_TEMP = 0x01
+SAMPLE_HAS_HUMID = 0x02
+SAMPLE_HAS_MOIST = 0x04
+
+MAX_PAYLOAD = 24
+
+
+def crc8(data: bytes) -> int:
+    """CRC-8, poly 0x07, init 0x00 (same as the firmware)."""
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def cobs_encode(data: bytes) -> bytes:
+    """COBS-encode data (no trailing delimiter)."""
+    out = bytearray()
+    block = bytearray()
+    for b in data:
+        if b == 0:
+            out.append(len(block) + 1)
+            out += block
+            block.clear()
+        else:
+            block.append(b)
+            if len(block) == 254:
+                out.append(0xFF)
+                out += block
+                block.clear()
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def encode_frame(frame_type: int, seq: int, payload: bytes = b"") -> bytes:
+    """Build a complete frame, delimiter included."""
+    if len(payload) > MAX_PAYLOAD:
+        raise ValueError(f"payload too long ({len(payload)} > {MAX_PAYLOAD})")
+    body = bytes([frame_type, seq & 0xFF]) + payload
+    return cobs_encode(body + bytes([crc8(body)])) + b"\x00"
+
+
+def sample_payload(temp: Optional[float] = None,
+                   humidity: Optional[int] = None,
+                   moisture: Optional[int] = None,
+                   channel: int = 0) -> bytes:
+    """
+    Pack a sensor sample; fields left as None are marked absent. The channel
+    byte is only added for channels other than 0.
+    """
+    fields = 0
+    if temp is not None:
+        fields |= SAMPLE_HAS_TEMP
+    if humidity is not None:
+        fields |= SAMPLE_HAS_HUMID
+    if moisture is not None:
+        fields |= SAMPLE_HAS_MOIST
+
+    payload = struct.pack(
+        "<BhBH",
+        fields,
+        int(round((temp or 0) * 10)),
+        max(0, min(255, int(humidity or 0))),
+        max(0, min(65535, int(moisture or 0))),
+    )
+    return payload + bytes([channel]) if channel else payload
@@ -0,0 +1,106 @@
+"""
+Replay a scripted command stream against the Uno LCD and report throughput.
+
+Flash the Uno with the `uno_profile` env first so it answers `P` with its
+render timing and RX buffer counters:
+
+    cd ArduinoUno-Firmware
+    pio run -e uno_profile -t upload
+
+Usage:
+    python lcd_bench.py [script.txt] [--repeat N]
+
+The script holds one serial command per line (blank lines and `#` comments
+are skipped). Without a script a default stream is used: sensor samples sent
+back-to-back like the /sensor handler does, with a mood flip every few samples.
+Lines are written without any pacing, i.e. at the full 115200 baud line rate.
+
+Without a board, point --port at the host build's pty (ArduinoUno-Firmware/sim,
+`lcd_sim --link /tmp/uno-tty`), or let it replay the script itself with
+`lcd_sim --replay script.txt`.
+"""
+
+import argparse
+import os
+import time
+
+import serial
+from dotenv import load_dotenv
+
+
+BAUDRATE = 115200
+BYTE_TIME_S = 10 / BAUDRATE  # 8N1: start + 8 data + stop bits
+
+
+def default_script() -> list:
+    """Sensor bursts crossing the moisture threshold every 4th sample."""
+    lines = []
+    for i in range(20):
+        moisture = 900 if (i // 4) % 2 else 2100
+        lines += [f"S T {20 + i % 5}", f"S H {40 + i % 7}", f"S M {moisture + i}"]
+    return lines
+
+
+def load_script(path: str) -> list:
+    with open(path) as f:
+        return [l.strip() for l in f if l.strip() and not l.startswith("#")]
+
+
+def read_reply(ser: serial.Serial) -> str:
+    return ser.readline().decode("utf-8", errors="replace").strip()
+
+
+def run(port: str, lines: list, repeat: int):
+    with serial.Serial(port, BAUDRATE, timeout=2.0) as ser:
+        time.sleep(2)  # Uno resets when the port opens
+        ser.reset_input_buffer()
+
+        # Clear the counters left over from the boot screen
+        ser.write(b"P\n")
+        read_reply(ser)
+
+        payload = "".join(l + "\n" for l in lines * repeat).encode("utf-8")
+        expected = len(lines) * repeat
+
+        start = time.perf_counter()
+        ser.write(payload)
+
+        replies = 0
+        errors = 0
+        while replies + errors < expected:
+            reply = read_reply(ser)
+            if not reply:
+                break  # timed out: the Uno dropped or mangled some lines
+            if reply.startswith("OK"):
+                replies += 1
+            else:
+                errors += 1
+        elapsed = time.perf_counter() - start
+
+        ser.write(b"P\n")
+        profile = read_reply(ser)
+
+    wire_time = len(payload) * BYTE_TIME_S
+    print(f"[Bench] {expected} commands, {len(payload)} bytes "
+          f"(wire time {wire_time * 1000:.0f} ms)")
+    print(f"[Bench] {replies} OK, {errors} errors, "
+          f"{expected - replies - errors} missing")
+    print(f"[Bench] {replies / elapsed:.1f} commands/s over {elapsed:.2f} s")
+    print(f"[Bench] Uno: {profile}")
+
+
+def main():
+    load_dotenv()
+
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("script", nargs="?", help="file with one command per line")
+    parser.add_argument("--repeat", type=int, default=1)
+    parser.add_argument("--port", default=os.getenv("ARDUINO_COM_PORT", "COM3"))
+    args = parser.parse_args()
+
+    lines = load_script(args.script) if args.script else default_script()
+    run(args.port, lines, args.repeat)
+
+
+if __name__ == "__main__":
+    main()
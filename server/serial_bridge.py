@@ -1,18 +1,56 @@
 """Serial bridge to Arduino Uno LCD."""
 
-import serial
+import threading
 import time
+from collections import OrderedDict
 from typing import Optional
 
+import serial
+
+from frames import (
+    FRAME_SAMPLE, FRAME_VIEW, FRAME_VOICE, VIEW_OVERVIEW, encode_frame, sample_payload,
+)
+
+
+def _stat(channel: int) -> str:
+    """Stat command prefix: "S" for channel 0, "S3" for channel 3."""
+    return f"S{channel}" if channel else "S"
+
+
+def _seq_covers(acked: int, seq: int) -> bool:
+    """True if a cumulative ack for `acked` covers `seq` (mod 256)."""
+    return ((acked - seq) & 0xFF) < 128
+
 
 class SerialBridge:
-    """Manages serial connection to Arduino Uno."""
+    """
+    Manages serial connection to Arduino Uno.
+
+    With window > 0 commands are tagged with a sequence number and up to
+    `window` of them are kept in flight; a reader thread handles the Uno's
+    ACK/BUSY/NAK/RDY replies (see shared/protocol.md). With window = 0 every
+    command waits 100 ms for its reply, like older firmware expects.
+    """
 
-    def __init__(self, port: str, baudrate: int = 115200, timeout: float = 1.0):
+    RETRIES = 3  # timeouts before the in-flight commands are dropped
+
+    def __init__(self, port: str, baudrate: int = 115200, timeout: float = 1.0,
+                 binary: bool = False, window: int = 0):
         self.port = port
         self.baudrate = baudrate
         self.timeout = timeout
         self.serial: Optional[serial.Serial] = None
+        self.binary_requested = binary
+        self.binary = False  # True once the Uno accepted binary frames
+        self.seq = 0
+        self.window = window
+
+        # Windowed mode: seq -> (frame type or None for text, payload)
+        self._in_flight = OrderedDict()
+        self._busy = False
+        self._cond = threading.Condition()
+        self._reader: Optional[threading.Thread] = None
+        self._running = False
 
     def connect(self) -> bool:
         """Open serial connection. Returns True if successful."""
@@ -25,17 +63,184 @@ class SerialBridge:
             # Wait for Arduino to reset after connection
             time.sleep(2)
             print(f"[SerialBridge] Connected to {self.port}")
+            if self.binary_requested:
+                self.negotiate_binary()
+            if self.window > 0:
+                self._start_reader()
             return True
         except serial.SerialException as e:
             print(f"[SerialBridge] Failed to connect: {e}")
             return False
 
+    def negotiate_binary(self) -> bool:
+        """
+        Ask the Uno to switch to binary frames. Stays on text commands if
+        the firmware does not answer (e.g. an older build).
+        """
+        self.binary = False
+        try:
+            self.serial.reset_input_buffer()
+            self.serial.write(b"B\n")
+            self.serial.flush()
+
+            deadline = time.monotonic() + self.timeout
+            while time.monotonic() < deadline:
+                response = self.serial.readline().decode('utf-8', errors='replace').strip()
+                if response == "OK BINARY":
+                    self.binary = True
+                    self.seq = 0
+                    break
+        except serial.SerialException as e:
+            print(f"[SerialBridge] Binary negotiation failed: {e}")
+
+        print(f"[SerialBridge] Using {'binary frames' if self.binary else 'text commands'}")
+        return self.binary
+
+    def _start_reader(self):
+        """Start the thread that handles acks in windowed mode."""
+        self._running = True
+        self._reader = threading.Thread(target=self._read_loop, daemon=True)
+        self._reader.start()
+        print(f"[SerialBridge] Windowed acks, {self.window} commands in flight")
+
+    def _read_loop(self):
+        while self._running:
+            try:
+                line = self.serial.readline().decode('utf-8', errors='replace').strip()
+                if line:
+                    self._handle_reply(line)
+            except ValueError:
+                print(f"[SerialBridge] Bad reply: {line}")
+            except (serial.SerialException, TypeError, AttributeError):
+                break  # port closed
+
+    def _handle_reply(self, line: str):
+        """Apply one reply from the Uno to the in-flight window."""
+        parts = line.split()
+        kind = parts[0]
+        if kind not in ("ACK", "BUSY", "NAK", "RDY") or len(parts) < 2:
+            print(f"[SerialBridge] Arduino response: {line}")
+            return
+
+        with self._cond:
+            if kind == "RDY":
+                self._busy = False
+            elif kind in ("ACK", "BUSY"):
+                self._ack(int(parts[1]))
+                self._busy = kind == "BUSY"
+            elif len(parts) > 2 and parts[2] == "BAD":
+                # Consumed but rejected: resending would not help
+                print(f"[SerialBridge] Command {parts[1]} rejected")
+                self._ack(int(parts[1]))
+            else:
+                print(f"[SerialBridge] {line}, resending")
+                self._resend_from(int(parts[1]))
+            self._cond.notify_all()
+
+    def _ack(self, acked: int):
+        """Drop everything a cumulative ack covers (lock held)."""
+        while self._in_flight:
+            seq = next(iter(self._in_flight))
+            if not _seq_covers(acked, seq):
+                break
+            self._in_flight.popitem(last=False)
+
+    def _resend_from(self, seq: int):
+        """
+        Go back to `seq` and resend the window (lock held). If the Uno
+        expects a seq we never sent (it was reset), renumber from there.
+        """
+        if seq in self._in_flight:
+            self._ack((seq - 1) & 0xFF)
+        else:
+            pending = list(self._in_flight.values())
+            self._in_flight.clear()
+            for i, item in enumerate(pending):
+                self._in_flight[(seq + i) & 0xFF] = item
+            self.seq = (seq + len(pending)) & 0xFF
+
+        for s, item in self._in_flight.items():
+            self._write(s, item)
+
+    def _write(self, seq: int, item: tuple):
+        """Write one tagged command or frame (lock held)."""
+        frame_type, payload = item
+        if frame_type is None:
+            data = f"#{seq} {payload}\n".encode('utf-8')
+        else:
+            data = encode_frame(frame_type, seq, payload)
+        self.serial.write(data)
+        self.serial.flush()
+
+    def _submit(self, item: tuple) -> bool:
+        """Queue a command once the window has room; does not wait for its ack."""
+        with self._cond:
+            for _ in range(self.RETRIES):
+                if self._cond.wait_for(
+                        lambda: len(self._in_flight) < self.window and not self._busy,
+                        timeout=self.timeout):
+                    break
+                # No reply in time: a lost RDY or lost acks, go back and resend
+                self._busy = False
+                if self._in_flight:
+                    print("[SerialBridge] Ack timeout, resending")
+                    self._resend_from(next(iter(self._in_flight)))
+            else:
+                print(f"[SerialBridge] No acks, dropping {len(self._in_flight)} commands")
+                self._in_flight.clear()
+
+            seq = self.seq
+            self.seq = (self.seq + 1) & 0xFF
+            self._in_flight[seq] = item
+            self._write(seq, item)
+            return True
+
+    def _read_response(self):
+        """Wait briefly and log the Arduino's response, if any."""
+        time.sleep(0.1)
+        if self.serial.in_waiting > 0:
+            response = self.serial.readline().decode('utf-8').strip()
+            print(f"[SerialBridge] Arduino response: {response}")
+
+    def send_frame(self, frame_type: int, payload: bytes = b"") -> bool:
+        """Send one binary frame (binary mode only)."""
+        if not self.serial or not self.serial.is_open:
+            print("[SerialBridge] Not connected")
+            return False
+
+        if self.window > 0:
+            try:
+                return self._submit((frame_type, payload))
+            except serial.SerialException as e:
+                print(f"[SerialBridge] Send failed: {e}")
+                return False
+
+        frame = encode_frame(frame_type, self.seq, payload)
+        try:
+            self.serial.write(frame)
+            self.serial.flush()
+            print(f"[SerialBridge] Sent frame type={frame_type} seq={self.seq} ({len(frame)} bytes)")
+            self.seq = (self.seq + 1) & 0xFF
+
+            self._read_response()
+            return True
+        except serial.SerialException as e:
+            print(f"[SerialBridge] Send failed: {e}")
+            return False
+
     def send(self, msg: str) -> bool:
         """Send a message to Arduino. Appends newline if not present."""
         if not self.serial or not self.serial.is_open:
             print("[SerialBridge] Not connected")
             return False
 
+        if self.window > 0:
+            try:
+                return self._submit((None, msg.strip()))
+            except serial.SerialException as e:
+                print(f"[SerialBridge] Send failed: {e}")
+                return False
+
         if not msg.endswith('\n'):
             msg += '\n'
 
@@ -45,35 +250,61 @@ class SerialBridge:
             print(f"[SerialBridge] Sent: {msg.strip()}")
             
             # Wait briefly and check for response
-            time.sleep(0.1)
-            if self.serial.in_waiting > 0:
-                response = self.serial.readline().decode('utf-8').strip()
-                print(f"[SerialBridge] Arduino response: {response}")
-            
+            self._read_response()
             return True
         except serial.SerialException as e:
             print(f"[SerialBridge] Send failed: {e}")
             return False
 
-    def send_temp(self, value: float) -> bool:
+    def send_temp(self, value: float, channel: int = 0) -> bool:
         """Send temperature update."""
-        return self.send(f"S T {value:.1f}")
+        return self.send(f"{_stat(channel)} T {value:.1f}")
 
-    def send_humidity(self, value: int) -> bool:
+    def send_humidity(self, value: int, channel: int = 0) -> bool:
         """Send humidity update."""
-        return self.send(f"S H {value}")
+        return self.send(f"{_stat(channel)} H {value}")
 
-    def send_moisture(self, value: int) -> bool:
+    def send_moisture(self, value: int, channel: int = 0) -> bool:
         """Send moisture update."""
-        return self.send(f"S M {value}")
+        return self.send(f"{_stat(channel)} M {value}")
+
+    def send_sample(self, temp: Optional[float] = None,
+                    humidity: Optional[int] = None,
+                    moisture: Optional[int] = None,
+                    channel: int = 0) -> bool:
+        """
+        Send a whole sensor sample of one channel (plant). In binary mode this
+        is one frame (and at most one redraw on the Uno); otherwise one text
+        command per field present.
+        """
+        if self.binary:
+            return self.send_frame(FRAME_SAMPLE, sample_payload(temp, humidity, moisture, channel))
+
+        ok = True
+        if temp is not None:
+            ok = self.send_temp(temp, channel) and ok
+        if humidity is not None:
+            ok = self.send_humidity(humidity, channel) and ok
+        if moisture is not None:
+            ok = self.send_moisture(moisture, channel) and ok
+        return ok
+
+    def send_view(self, channel: Optional[int]) -> bool:
+        """Show one channel on the LCD, or the overview of all of them (None)."""
+        if self.binary:
+            return self.send_frame(FRAME_VIEW, bytes([VIEW_OVERVIEW if channel is None else channel]))
+        return self.send("O" if channel is None else f"C {channel}")
 
     def send_voice(self, text: str) -> bool:
         """Send voice text (max 20 chars)."""
         truncated = text[:20]
+        if self.binary:
+            return self.send_frame(FRAME_VOICE, truncated.encode('utf-8')[:20])
         return self.send(f"V {truncated}")
 
     def close(self):
         """Close serial connection."""
+        self._running = False
         if self.serial and self.serial.is_open:
             self.serial.close()
             print("[SerialBridge] Connection closed")